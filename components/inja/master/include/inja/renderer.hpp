@@ -999,8 +999,16 @@ class Renderer : public NodeVisitor {
       make_result(value.valid() && (value.node.is_val() || value.node.is_keyval()) && value.kind() == NativeKind::String);
     } break;
     case Op::Callback: {
+      // Resolve the callback against the rendering environment so that a parsed
+      // template can be shared between environments with different callbacks.
       auto args = get_argument_vector(node);
-      data_eval_stack.emplace_back(node.callback(args, additional_data));
+      const auto function_data = function_storage.find_function(node.name, node.number_args);
+      if (function_data.operation != Op::Callback || !function_data.callback) {
+        throw_renderer_error("unknown function '" + node.name + "'", node);
+        make_null_result();
+        break;
+      }
+      data_eval_stack.emplace_back(function_data.callback(args, additional_data));
     } break;
     case Op::Macro: {
       make_result(evaluate_macro(node));
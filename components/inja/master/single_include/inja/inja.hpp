@@ -4450,6 +4450,16 @@ public:
     render_config.html_autoescape = will_escape;
   }
 
+  /// Returns the lexer configuration used when parsing templates
+  const LexerConfig& get_lexer_config() const {
+    return lexer_config;
+  }
+
+  /// Returns the parser configuration used when parsing templates
+  const ParserConfig& get_parser_config() const {
+    return parser_config;
+  }
+
   Template parse(std::string_view input) {
     Parser parser(parser_config, lexer_config, template_storage, function_storage);
     return parser.parse(input, input_path);
@@ -314,6 +314,9 @@ Tree::Tree(Callbacks const& cb)
     , m_free_tail(NONE)
     , m_arena()
     , m_arena_pos(0)
+    , m_arena_chunks(nullptr)
+    , m_arena_retired_size(0)
+    , m_arena_retired_capacity(0)
     , m_callbacks(cb)
     , m_flags(TREEF_NONE)
 {
@@ -370,6 +373,13 @@ void Tree::_free()
         _RYML_CB_ASSERT(m_callbacks, m_arena.len > 0);
         _RYML_CB_FREE(m_callbacks, m_arena.str, char, m_arena.len);
     }
+    while(m_arena_chunks)
+    {
+        ArenaChunk *next = m_arena_chunks->next;
+        _RYML_CB_FREE(m_callbacks, m_arena_chunks->buf.str, char, m_arena_chunks->buf.len);
+        _RYML_CB_FREE(m_callbacks, m_arena_chunks, ArenaChunk, 1);
+        m_arena_chunks = next;
+    }
     _clear();
 }
 
@@ -388,6 +398,9 @@ void Tree::_clear()
     m_free_tail = 0;
     m_arena = {};
     m_arena_pos = 0;
+    m_arena_chunks = nullptr;
+    m_arena_retired_size = 0;
+    m_arena_retired_capacity = 0;
     m_flags = TREEF_NONE;
     for(size_t i = 0; i < RYML_MAX_TAG_DIRECTIVES; ++i)
         m_tag_directives[i] = {};
@@ -407,7 +420,11 @@ void Tree::_copy(Tree const& that)
     m_arena_pos = that.m_arena_pos;
     m_flags = that.m_flags;
     m_arena = that.m_arena;
-    if(that.m_arena.str)
+    if(that.m_arena_chunks)
+    {
+        _copy_chunked_arena(that);
+    }
+    else if(that.m_arena.str)
     {
         _RYML_CB_ASSERT(m_callbacks, that.m_arena.len > 0);
         substr arena;
@@ -432,12 +449,122 @@ void Tree::_move(Tree & that)
     m_free_tail = that.m_free_tail;
     m_arena = that.m_arena;
     m_arena_pos = that.m_arena_pos;
+    m_arena_chunks = that.m_arena_chunks;
+    m_arena_retired_size = that.m_arena_retired_size;
+    m_arena_retired_capacity = that.m_arena_retired_capacity;
     m_flags = that.m_flags;
     for(size_t i = 0; i < RYML_MAX_TAG_DIRECTIVES; ++i)
         m_tag_directives[i] = that.m_tag_directives[i];
     that._clear();
 }
 
+/** copy a chunked arena into a single contiguous arena, remapping every
+ * node string from the chunk it lived in. The current chunk is placed
+ * first, followed by the retired chunks from the most recent. */
+void Tree::_copy_chunked_arena(Tree const& that)
+{
+    const size_t total = that.arena_total_size();
+    substr arena;
+    arena.len = total + that.arena_slack();
+    arena.str = _RYML_CB_ALLOC_HINT(m_callbacks, char, arena.len, that.m_arena.str);
+    memcpy(arena.str, that.m_arena.str, that.m_arena_pos);
+    size_t offset = that.m_arena_pos;
+    for(ArenaChunk const* chunk = that.m_arena_chunks; chunk; chunk = chunk->next)
+    {
+        memcpy(arena.str + offset, chunk->buf.str, chunk->used);
+        offset += chunk->used;
+    }
+
+    auto remap = [&](csubstr &s) {
+        if(s.str == nullptr)
+            return;
+        if(that.m_arena.is_super(s))
+        {
+            s = csubstr(arena.str + (s.str - that.m_arena.str), s.len);
+            return;
+        }
+        size_t chunk_offset = that.m_arena_pos;
+        for(ArenaChunk const* chunk = that.m_arena_chunks; chunk; chunk = chunk->next)
+        {
+            if(chunk->buf.is_super(s))
+            {
+                s = csubstr(arena.str + chunk_offset + (s.str - chunk->buf.str), s.len);
+                return;
+            }
+            chunk_offset += chunk->used;
+        }
+    };
+    for(NodeData *C4_RESTRICT n = m_buf, *e = m_buf + m_cap; n != e; ++n)
+    {
+        remap(n->m_key.scalar);
+        remap(n->m_key.tag);
+        remap(n->m_key.anchor);
+        remap(n->m_val.scalar);
+        remap(n->m_val.tag);
+        remap(n->m_val.anchor);
+    }
+    for(TagDirective &C4_RESTRICT td : m_tag_directives)
+    {
+        remap(td.prefix);
+        remap(td.handle);
+    }
+    m_arena = arena;
+    m_arena_pos = total;
+}
+
+void Tree::clear_arena()
+{
+    while(m_arena_chunks)
+    {
+        ArenaChunk *next = m_arena_chunks->next;
+        _RYML_CB_FREE(m_callbacks, m_arena_chunks->buf.str, char, m_arena_chunks->buf.len);
+        _RYML_CB_FREE(m_callbacks, m_arena_chunks, ArenaChunk, 1);
+        m_arena_chunks = next;
+    }
+    m_arena_retired_size = 0;
+    m_arena_retired_capacity = 0;
+    m_arena_pos = 0;
+}
+
+size_t Tree::arena_num_chunks() const
+{
+    size_t num = m_arena.str ? 1 : 0;
+    for(ArenaChunk const* chunk = m_arena_chunks; chunk; chunk = chunk->next)
+        ++num;
+    return num;
+}
+
+bool Tree::_in_retired_chunk(csubstr s) const
+{
+    for(ArenaChunk const* chunk = m_arena_chunks; chunk; chunk = chunk->next)
+        if(chunk->buf.is_super(s))
+            return true;
+    return false;
+}
+
+/** retire the current arena chunk and continue in a new one that can hold
+ * at least the required size. Strings in the retired chunk are never moved. */
+substr Tree::_add_arena_chunk(size_t required)
+{
+    _RYML_CB_ASSERT(m_callbacks, m_arena.str != nullptr);
+    ArenaChunk *chunk = _RYML_CB_ALLOC_HINT(m_callbacks, ArenaChunk, 1, nullptr);
+    chunk->buf = m_arena;
+    chunk->used = m_arena_pos;
+    chunk->next = m_arena_chunks;
+    m_arena_chunks = chunk;
+    m_arena_retired_size += m_arena_pos;
+    m_arena_retired_capacity += m_arena.len;
+
+    size_t cap = required > 2 * m_arena.len ? required : 2 * m_arena.len;
+    cap = cap < 64 ? 64 : cap;
+    substr buf;
+    buf.str = (char*) m_callbacks.m_allocate(cap, m_arena.str, m_callbacks.m_user_data);
+    buf.len = cap;
+    m_arena = buf;
+    m_arena_pos = 0;
+    return m_arena;
+}
+
 void Tree::_relocate(substr next_arena)
 {
     _RYML_CB_ASSERT(m_callbacks, next_arena.not_empty());
@@ -445,24 +572,24 @@ void Tree::_relocate(substr next_arena)
     memcpy(next_arena.str, m_arena.str, m_arena_pos);
     for(NodeData *C4_RESTRICT n = m_buf, *e = m_buf + m_cap; n != e; ++n)
     {
-        if(in_arena(n->m_key.scalar))
+        if(m_arena.is_super(n->m_key.scalar))
             n->m_key.scalar = _relocated(n->m_key.scalar, next_arena);
-        if(in_arena(n->m_key.tag))
+        if(m_arena.is_super(n->m_key.tag))
             n->m_key.tag = _relocated(n->m_key.tag, next_arena);
-        if(in_arena(n->m_key.anchor))
+        if(m_arena.is_super(n->m_key.anchor))
             n->m_key.anchor = _relocated(n->m_key.anchor, next_arena);
-        if(in_arena(n->m_val.scalar))
+        if(m_arena.is_super(n->m_val.scalar))
             n->m_val.scalar = _relocated(n->m_val.scalar, next_arena);
-        if(in_arena(n->m_val.tag))
+        if(m_arena.is_super(n->m_val.tag))
             n->m_val.tag = _relocated(n->m_val.tag, next_arena);
-        if(in_arena(n->m_val.anchor))
+        if(m_arena.is_super(n->m_val.anchor))
             n->m_val.anchor = _relocated(n->m_val.anchor, next_arena);
     }
     for(TagDirective &C4_RESTRICT td : m_tag_directives)
     {
-        if(in_arena(td.prefix))
+        if(m_arena.is_super(td.prefix))
             td.prefix = _relocated(td.prefix, next_arena);
-        if(in_arena(td.handle))
+        if(m_arena.is_super(td.handle))
             td.handle = _relocated(td.handle, next_arena);
     }
 }
@@ -451,6 +451,9 @@ public:
     enum TreeFlags_e : tree_flags {
         TREEF_NONE             = 0u,
         TREEF_NO_ARENA_REALLOC = 1u << 0,
+        /** grow the arena by adding chunks instead of relocating it, so
+         * every string already in the arena stays valid */
+        TREEF_CHUNKED_ARENA    = 1u << 1,
     };
 
     /** @} */
@@ -486,7 +489,7 @@ public:
      * @note does NOT clear the arena
      * @see clear_arena() */
     void clear();
-    inline void clear_arena() { m_arena_pos = 0; }
+    void clear_arena();
 
     inline bool   empty() const { return m_size == 0; }
 
@@ -522,6 +525,23 @@ public:
         return (m_flags & TREEF_NO_ARENA_REALLOC) != 0;
     }
 
+    /** grow the arena by adding chunks rather than relocating it. Strings
+     * already in the arena are never moved, so they remain valid without an
+     * upper bound on the arena size. */
+    void use_chunked_arena(bool chunked=true)
+    {
+        if(chunked)
+            add_flags(TREEF_CHUNKED_ARENA);
+        else
+            rem_flags(TREEF_CHUNKED_ARENA);
+    }
+
+    /** true when the arena grows by adding chunks. */
+    bool is_arena_chunked() const
+    {
+        return (m_flags & TREEF_CHUNKED_ARENA) != 0;
+    }
+
     /** @} */
 
 public:
@@ -1016,13 +1036,22 @@ public:
     /** get the current slack of the tree's internal arena */
     inline size_t arena_slack() const { RYML_ASSERT(m_arena.len >= m_arena_pos); return m_arena.len - m_arena_pos; }
 
-    /** get the current arena */
+    /** get the current arena. When the arena is chunked this is the
+     * current chunk only. */
     substr arena() const { return m_arena.first(m_arena_pos); }
 
+    /** get the number of arena bytes in use, including retired chunks.
+     * The arena never shrinks, so this is also its high-water mark. */
+    inline size_t arena_total_size() const { return m_arena_retired_size + m_arena_pos; }
+    /** get the capacity of the arena, including retired chunks */
+    inline size_t arena_total_capacity() const { return m_arena_retired_capacity + m_arena.len; }
+    /** get the number of chunks making up the arena */
+    size_t arena_num_chunks() const;
+
     /** return true if the given substring is part of the tree's string arena */
     bool in_arena(csubstr s) const
     {
-        return m_arena.is_super(s);
+        return m_arena.is_super(s) || (m_arena_chunks != nullptr && _in_retired_chunk(s));
     }
 
     /** serialize the given floating-point variable to the tree's
@@ -1208,6 +1237,8 @@ private:
 
     substr _grow_arena(size_t more)
     {
+        if(m_arena.str != nullptr && is_arena_chunked())
+            return _add_arena_chunk(more + arena_slack());
         size_t cap = m_arena.len + more;
         cap = cap < 2 * m_arena.len ? 2 * m_arena.len : cap;
         cap = cap < 64 ? 64 : cap;
@@ -1215,6 +1246,9 @@ private:
         return m_arena.sub(m_arena_pos);
     }
 
+    substr _add_arena_chunk(size_t required);
+    bool _in_retired_chunk(csubstr s) const;
+
     substr _request_span(size_t sz)
     {
         substr s;
@@ -1306,6 +1340,7 @@ private:
     void _move(Tree      & that);
 
     void _relocate(substr next_arena);
+    void _copy_chunked_arena(Tree const& that);
 
 public:
 
@@ -1526,6 +1561,17 @@ public:
     substr m_arena;
     size_t m_arena_pos;
 
+    /** arena chunks retired by _add_arena_chunk(), most recent first */
+    struct ArenaChunk
+    {
+        substr      buf;
+        size_t      used;
+        ArenaChunk *next;
+    };
+    ArenaChunk *m_arena_chunks;
+    size_t m_arena_retired_size;
+    size_t m_arena_retired_capacity;
+
     Callbacks m_callbacks;
 
     tree_flags m_flags;
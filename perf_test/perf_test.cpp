@@ -1,5 +1,6 @@
 #include "nlohmann/json.hpp"
 #include "yaml-cpp/yaml.h"
+#include "ryml_merge.hpp"
 //#include "scnlib.h"
 #include <random>
 #include <string>
@@ -9,6 +10,7 @@
 void insert_as_map(const std::vector<std::string>& data);
 void insert_as_sequence(const std::vector<std::string>& data);
 std::string random_string(int string_length);
+void merge_ryml_maps(int entry_count);
 
 int main(int argc, const char** argv)
 {
@@ -38,6 +40,8 @@ int main(int argc, const char** argv)
         std::string temp = i;//.get<std::string>();
         std::cout << temp << "\n";
     }
+
+    merge_ryml_maps(20000);
     
     return 0;
 }
@@ -100,4 +104,31 @@ void insert_as_sequence(const std::vector<std::string>& data)
 
     duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
     std::cout << duration << "ms to insert YAML sequence\n";
-}
\ No newline at end of file
+}
+
+void merge_ryml_maps(int entry_count)
+{
+    // Build a map of entries shaped like component data
+    std::string yaml;
+    for (int i=0; i < entry_count; ++i)
+        yaml += "entry_" + std::to_string(i) + ": {a: [1, 2, 3], b: " + std::to_string(i) + ", c: {d: value_" + std::to_string(i) + "}}\n";
+    ryml::Tree source = ryml::parse_in_arena(ryml::to_csubstr(yaml));
+
+    // Merge into an empty map
+    ryml::Tree destination;
+    destination.rootref() |= ryml::MAP;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    yakka::ryml_merge(destination.rootref(), source.crootref());
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    std::cout << duration << "ms to merge " << entry_count << " entries into an empty ryml map\n";
+
+    // Merge again, so every key is found in the filled map
+    t1 = std::chrono::high_resolution_clock::now();
+    yakka::ryml_merge(destination.rootref(), source.crootref());
+    t2 = std::chrono::high_resolution_clock::now();
+
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    std::cout << duration << "ms to merge " << entry_count << " entries into a filled ryml map\n";
+}
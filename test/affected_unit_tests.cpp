@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "affected.hpp"
+#include "dependency_log.hpp"
+#include "ryml_snapshot.hpp"
+#include "yakka.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void save_snapshot(const fs::path &filename, const char *yaml, const char *key = nullptr)
+{
+  ryml::Tree tree = ryml::parse_in_arena(ryml::to_csubstr(yaml));
+  std::ofstream(filename, std::ios::binary) << yakka::ryml_snapshot(key ? tree[ryml::to_csubstr(key)] : tree.crootref());
+}
+
+// Saves the state a build of an application with a single object file leaves in its output directory
+fs::path create_project(const fs::path &test_dir)
+{
+  const auto output = test_dir / "app";
+  fs::create_directories(output);
+  const auto depfile = (output / "main.d").generic_string();
+  std::ofstream(depfile) << "main.o: ./src/main.c inc/common.h\n";
+
+  save_snapshot(output / yakka::project_snapshot_filename, "current: {project_name: app, project_file: app.yakka, components: {board: {yakka_file: boards/board.yakka}}}", "current");
+  save_snapshot(output / yakka::target_graph_filename, ("{app.elf: {dependencies: [main.o, board.o], depfiles: []}, main.o: {dependencies: [src/main.c], depfiles: ['" + depfile + "']}, board.o: {dependencies: [boards/board.c], depfiles: []}}").c_str());
+
+  yakka::dependency_log log;
+  log.get_dependencies(depfile);
+  log.save(output / yakka::dependency_log_filename);
+  return output;
+}
+
+} // namespace
+
+TEST(AffectedTest, HeaderFromDepfileAffectsDependents)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_affected_test";
+  const auto output   = create_project(test_dir);
+
+  const auto affected = yakka::find_affected_targets(output, { "inc/common.h" });
+  ASSERT_TRUE(affected.has_value());
+  EXPECT_EQ(affected->name, "app");
+  EXPECT_FALSE(affected->rebuild_all);
+  EXPECT_EQ(affected->targets, (std::vector<std::string>{ "app.elf", "main.o" }));
+
+  EXPECT_FALSE(yakka::find_affected_targets(output, { "docs/readme.md" }).has_value());
+
+  fs::remove_all(test_dir);
+}
+
+TEST(AffectedTest, ComponentFileAffectsAllTargets)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_affected_component_test";
+  const auto output   = create_project(test_dir);
+
+  const auto affected = yakka::find_affected_projects(test_dir, { yakka::workspace_relative_path("./boards/../boards/board.yakka", fs::current_path()) });
+  ASSERT_EQ(affected.size(), 1);
+  EXPECT_TRUE(affected[0].rebuild_all);
+  EXPECT_EQ(affected[0].targets.size(), 3);
+
+  fs::remove_all(test_dir);
+}
+
+TEST(AffectedTest, TargetsInCycleFollowLaterResolvedDependency)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_affected_cycle_test";
+  const auto output   = test_dir / "app";
+  fs::create_directories(output);
+  save_snapshot(output / yakka::project_snapshot_filename, "current: {project_name: app, project_file: app.yakka}", "current");
+  // `y` is reached through `x` before `x` is known to be affected by its second dependency
+  save_snapshot(output / yakka::target_graph_filename, "{x: {dependencies: [y, src/x.c]}, y: {dependencies: [x]}, z: {dependencies: [src/z.c]}}");
+
+  const auto affected = yakka::find_affected_targets(output, { "src/x.c" });
+  ASSERT_TRUE(affected.has_value());
+  EXPECT_EQ(affected->targets, (std::vector<std::string>{ "x", "y" }));
+
+  fs::remove_all(test_dir);
+}
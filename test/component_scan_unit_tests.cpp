@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "component_database.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void write_component(const fs::path &file)
+{
+  fs::create_directories(file.parent_path());
+  std::ofstream(file) << "name: " << file.stem().string() << "\n";
+}
+
+} // namespace
+
+TEST(ComponentScanTest, FindsNestedComponentsAndPrunesIgnoredDirectories)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_component_scan_test";
+  fs::remove_all(test_dir);
+  write_component(test_dir / "components" / "a" / "a.yakka");
+  write_component(test_dir / "components" / "a" / "deep" / "er" / "b.yakka");
+  write_component(test_dir / "components" / ".hidden.yakka");
+  write_component(test_dir / ".git" / "c.yakka");
+  write_component(test_dir / "output" / "d.yakka");
+  write_component(test_dir / "sdk" / "output" / "i.yakka");
+  write_component(test_dir / ".yakka" / "repos" / "e.yakka");
+  write_component(test_dir / "vendor" / "f.yakka");
+  write_component(test_dir / "sdk" / "vendor" / "g.yakka");
+  write_component(test_dir / "third_party" / "h.yakka");
+  fs::create_directory_symlink(test_dir / "components", test_dir / "link");
+
+  yakka::component_database db;
+  db.scan_ignore.push_back("third_party");
+  db.scan_ignore.push_back("sdk/vendor");
+  db.scan_for_components(test_dir);
+
+  EXPECT_TRUE(db.get_component(std::string{ "a" }).has_value());
+  EXPECT_TRUE(db.get_component(std::string{ "b" }).has_value());
+  EXPECT_TRUE(db.get_component(std::string{ "f" }).has_value()) << "Paths with '/' only match relative to the scan root";
+  EXPECT_TRUE(db.get_component(std::string{ "i" }).has_value()) << "Only the project output directory at the root is skipped";
+  for (const auto *id: { ".hidden", "c", "d", "e", "g", "h" })
+    EXPECT_FALSE(db.get_component(std::string{ id }).has_value()) << id;
+  EXPECT_EQ(db.database["components"]["a"].num_children(), 1) << "Symbolic links to directories are not followed";
+
+  fs::remove_all(test_dir);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "dependency_log.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::vector<std::string> parse(std::string_view contents)
+{
+  std::vector<std::string> result;
+  yakka::dependency_log::parse_depfile_contents(contents, [&](std::string_view path) {
+    result.emplace_back(path);
+  });
+  return result;
+}
+} // namespace
+
+TEST(DependencyLogTest, ParsesContinuationsAndEscapes)
+{
+  const auto result = parse("output/a.o: a.c include/a\\ b.h \\\n  inc/$$x.h \\\r\n  inc/c\\#.h\n");
+  EXPECT_EQ(result, (std::vector<std::string>{ "a.c", "include/a b.h", "inc/$x.h", "inc/c#.h" }));
+}
+
+TEST(DependencyLogTest, SkipsPhonyTargets)
+{
+  const auto result = parse("a.o: a.c a.h\n\na.h:\n");
+  EXPECT_EQ(result, (std::vector<std::string>{ "a.c", "a.h" }));
+}
+
+TEST(DependencyLogTest, SkipsTargetsBeforeASeparateColon)
+{
+  const auto result = parse("a.o b.o : a.c \\\r\n a.h\nc.h :\n");
+  EXPECT_EQ(result, (std::vector<std::string>{ "a.c", "a.h" }));
+}
+
+TEST(DependencyLogTest, InternsSharedPaths)
+{
+  yakka::dependency_log log;
+  EXPECT_EQ(log.intern("sdk/common.h"), log.intern("sdk/common.h"));
+  EXPECT_NE(log.intern("sdk/common.h"), log.intern("sdk/other.h"));
+}
+
+TEST(DependencyLogTest, RoundTripsThroughBinaryLog)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_dependency_log_test";
+  fs::create_directories(test_dir);
+  const auto depfile = (test_dir / "a.d").generic_string();
+  std::ofstream(depfile) << "a.o: ./a.c common.h \\\n common.h\n";
+
+  yakka::dependency_log log;
+  const auto dependencies = log.get_dependencies(depfile);
+  ASSERT_EQ(dependencies.size(), 2);
+  EXPECT_EQ(dependencies[0], ryml::csubstr("a.c"));
+  ASSERT_TRUE(log.save(test_dir / "yakka.deps"));
+
+  yakka::dependency_log loaded;
+  ASSERT_TRUE(loaded.load(test_dir / "yakka.deps"));
+  EXPECT_FALSE(loaded.is_dirty());
+  const auto reloaded = loaded.get_dependencies(depfile);
+  EXPECT_FALSE(loaded.is_dirty()) << "An up to date record should not re-parse the depfile";
+  ASSERT_EQ(reloaded.size(), 2);
+  EXPECT_EQ(reloaded[1], ryml::csubstr("common.h"));
+
+  fs::remove_all(test_dir);
+}
+
+TEST(DependencyLogTest, LoadKeepsExistingIds)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_dependency_log_merge_test";
+  fs::create_directories(test_dir);
+  const auto depfile = (test_dir / "a.d").generic_string();
+  std::ofstream(depfile) << "a.o: a.c common.h\n";
+
+  yakka::dependency_log saved;
+  saved.get_dependencies(depfile);
+  ASSERT_TRUE(saved.save(test_dir / "yakka.deps"));
+
+  yakka::dependency_log log;
+  const auto other_id = log.intern("other.h");
+  ASSERT_TRUE(log.load(test_dir / "yakka.deps"));
+  EXPECT_TRUE(log.is_dirty());
+  EXPECT_EQ(log.path(other_id), ryml::csubstr("other.h"));
+  const auto *r = log.find(depfile);
+  ASSERT_NE(r, nullptr);
+  ASSERT_EQ(r->dependencies.size(), 2);
+  EXPECT_EQ(log.path(r->dependencies[0]), ryml::csubstr("a.c"));
+  EXPECT_EQ(log.path(r->dependencies[1]), ryml::csubstr("common.h"));
+
+  fs::remove_all(test_dir);
+}
+
+TEST(DependencyLogTest, SaveDropsMissingDepfiles)
+{
+  const auto test_dir = fs::temp_directory_path() / "yakka_dependency_log_prune_test";
+  fs::create_directories(test_dir);
+  const auto kept    = (test_dir / "a.d").generic_string();
+  const auto removed = (test_dir / "b.d").generic_string();
+  std::ofstream(kept) << "a.o: a.c common.h\n";
+  std::ofstream(removed) << "b.o: b.c common.h\n";
+
+  yakka::dependency_log log;
+  log.get_dependencies(kept);
+  log.get_dependencies(removed);
+  fs::remove(removed);
+  ASSERT_TRUE(log.save(test_dir / "yakka.deps"));
+  EXPECT_EQ(log.find(removed), nullptr);
+
+  yakka::dependency_log loaded;
+  ASSERT_TRUE(loaded.load(test_dir / "yakka.deps"));
+  EXPECT_FALSE(loaded.find_path("b.c").has_value());
+  const auto *r = loaded.find(kept);
+  ASSERT_NE(r, nullptr);
+  ASSERT_EQ(r->dependencies.size(), 2);
+  EXPECT_EQ(loaded.path(r->dependencies[1]), ryml::csubstr("common.h"));
+
+  fs::remove_all(test_dir);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Fills a sequence with distinct values copied into the arena, enough to span several chunks
+std::vector<std::string> fill(ryml::Tree &tree, size_t count)
+{
+  std::vector<std::string> values;
+  auto root = tree.rootref();
+  root |= ryml::SEQ;
+  for (size_t n = 0; n < count; ++n) {
+    values.push_back("value number " + std::to_string(n) + " padded to span chunks");
+    root.append_child().set_val(tree.copy_to_arena(ryml::to_csubstr(values.back())));
+  }
+  return values;
+}
+
+std::vector<ryml::csubstr> scalars(const ryml::Tree &tree)
+{
+  std::vector<ryml::csubstr> result;
+  for (const auto child: tree.crootref().children())
+    result.push_back(child.val());
+  return result;
+}
+
+void expect_values(const ryml::Tree &tree, const std::vector<std::string> &values)
+{
+  const auto found = scalars(tree);
+  ASSERT_EQ(found.size(), values.size());
+  for (size_t n = 0; n < values.size(); ++n)
+    EXPECT_EQ(found[n], ryml::to_csubstr(values[n]));
+}
+
+} // namespace
+
+TEST(RymlArenaTest, GrowsAcrossChunksWithoutMovingStrings)
+{
+  ryml::Tree tree(16, 64);
+  tree.use_chunked_arena();
+  std::vector<ryml::csubstr> first_strings;
+  auto root = tree.rootref();
+  root |= ryml::SEQ;
+  std::vector<std::string> values;
+  for (size_t n = 0; n < 500; ++n) {
+    values.push_back("value number " + std::to_string(n) + " padded to span chunks");
+    first_strings.push_back(tree.copy_to_arena(ryml::to_csubstr(values.back())));
+    root.append_child().set_val(first_strings.back());
+  }
+
+  EXPECT_GT(tree.arena_num_chunks(), 2u);
+  size_t total = 0;
+  for (const auto &v: values)
+    total += v.size();
+  EXPECT_EQ(tree.arena_total_size(), total);
+  EXPECT_GE(tree.arena_total_capacity(), total);
+
+  // Every string handed out stays where it was written
+  const auto found = scalars(tree);
+  for (size_t n = 0; n < values.size(); ++n) {
+    EXPECT_EQ(found[n].str, first_strings[n].str);
+    EXPECT_EQ(first_strings[n], ryml::to_csubstr(values[n]));
+  }
+}
+
+TEST(RymlArenaTest, InArenaCoversEveryChunk)
+{
+  ryml::Tree tree(16, 64);
+  tree.use_chunked_arena();
+  const auto values = fill(tree, 500);
+  ASSERT_GT(tree.arena_num_chunks(), 2u);
+
+  for (const auto s: scalars(tree))
+    EXPECT_TRUE(tree.in_arena(s)) << s;
+  EXPECT_FALSE(tree.in_arena(ryml::to_csubstr(values.front())));
+
+  ryml::Tree other(16, 64);
+  other.use_chunked_arena();
+  fill(other, 500);
+  for (const auto s: scalars(other))
+    EXPECT_FALSE(tree.in_arena(s));
+}
+
+TEST(RymlArenaTest, CopyConsolidatesChunks)
+{
+  std::vector<std::string> values;
+  ryml::Tree copy;
+  {
+    ryml::Tree tree(16, 64);
+    tree.use_chunked_arena();
+    values = fill(tree, 500);
+    ASSERT_GT(tree.arena_num_chunks(), 2u);
+
+    copy = tree;
+    EXPECT_EQ(copy.arena_num_chunks(), 1u);
+    EXPECT_EQ(copy.arena_total_size(), tree.arena_total_size());
+    for (const auto s: scalars(copy)) {
+      EXPECT_TRUE(copy.in_arena(s));
+      EXPECT_FALSE(tree.in_arena(s));
+    }
+  }
+  // The copy no longer refers to the source chunks once they are freed
+  expect_values(copy, values);
+}
+
+TEST(RymlArenaTest, MoveKeepsChunks)
+{
+  ryml::Tree tree(16, 64);
+  tree.use_chunked_arena();
+  const auto values  = fill(tree, 500);
+  const auto before  = scalars(tree);
+  const auto chunks  = tree.arena_num_chunks();
+  const auto total   = tree.arena_total_size();
+
+  ryml::Tree moved(std::move(tree));
+  EXPECT_EQ(moved.arena_num_chunks(), chunks);
+  EXPECT_EQ(moved.arena_total_size(), total);
+  EXPECT_EQ(tree.arena_num_chunks(), 0u);
+  const auto after = scalars(moved);
+  ASSERT_EQ(after.size(), before.size());
+  for (size_t n = 0; n < after.size(); ++n) {
+    EXPECT_EQ(after[n].str, before[n].str);
+    EXPECT_TRUE(moved.in_arena(after[n]));
+  }
+  expect_values(moved, values);
+}
+
+TEST(RymlArenaTest, RelocationOnlyMovesTheCurrentChunk)
+{
+  ryml::Tree tree(16, 64);
+  tree.use_chunked_arena();
+  const auto values = fill(tree, 500);
+  const auto before = scalars(tree);
+  ASSERT_GT(tree.arena_num_chunks(), 2u);
+
+  tree.reserve_arena(tree.arena_capacity() * 4);
+  const auto after = scalars(tree);
+  size_t moved = 0;
+  for (size_t n = 0; n < after.size(); ++n) {
+    EXPECT_TRUE(tree.in_arena(after[n]));
+    if (after[n].str != before[n].str)
+      ++moved;
+  }
+  EXPECT_GT(moved, 0u);
+  EXPECT_LT(moved, after.size());
+  expect_values(tree, values);
+}
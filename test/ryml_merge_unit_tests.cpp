@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "ryml_merge.hpp"
+#include <string>
+
+namespace {
+
+std::string to_yaml(ryml::ConstNodeRef node)
+{
+  return ryml::emitrs_yaml<std::string>(node);
+}
+
+std::string normalized(const char *yaml)
+{
+  ryml::Tree tree = ryml::parse_in_arena(ryml::to_csubstr(yaml));
+  return to_yaml(tree.crootref());
+}
+
+} // namespace
+
+TEST(RymlMergeTest, CopyOutlivesSourceTree)
+{
+  ryml::Tree destination;
+  destination.rootref() |= ryml::MAP;
+  auto node = destination.rootref().append_child() << ryml::key("copy");
+  {
+    ryml::Tree source = ryml::parse_in_arena(ryml::to_csubstr("a: {b: [1, 2, same], c: same, d: same}\ne: 3"));
+    yakka::ryml_copy(node, source.crootref());
+    source.clear();
+    source.clear_arena();
+  }
+  EXPECT_EQ(to_yaml(destination.crootref()), normalized("copy: {a: {b: [1, 2, same], c: same, d: same}, e: 3}"));
+}
+
+TEST(RymlMergeTest, MergesMapsAndAppendsSequences)
+{
+  ryml::Tree destination = ryml::parse_in_arena(ryml::to_csubstr("a: {b: 1, s: [x]}\nv: 1"));
+  ryml::Tree source      = ryml::parse_in_arena(ryml::to_csubstr("a: {b: 2, c: {d: [1]}, s: [y]}\nv: 2"));
+  yakka::ryml_merge(destination.rootref(), source.crootref());
+  EXPECT_EQ(to_yaml(destination.crootref()), normalized("a: {b: 2, s: [x, y], c: {d: [1]}}\nv: 2"));
+}
+
+TEST(RymlMergeTest, MergesSequenceEntriesByKey)
+{
+  ryml::Tree destination = ryml::parse_in_arena(ryml::to_csubstr("l: [{name: p, v: 1}]"));
+  ryml::Tree source      = ryml::parse_in_arena(ryml::to_csubstr("l: [{name: p, w: 2}, {name: q}]"));
+  yakka::ryml_merge(destination.rootref(), source.crootref(), { ryml::csubstr("name") });
+  EXPECT_EQ(to_yaml(destination.crootref()), normalized("l: [{name: p, v: 1, w: 2}, {name: q}]"));
+}
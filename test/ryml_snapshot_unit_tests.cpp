@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+#include "ryml_snapshot.hpp"
+#include <string>
+
+TEST(RymlSnapshotTest, RoundTripsSubtree)
+{
+  ryml::Tree source = ryml::parse_in_arena(ryml::to_csubstr("current:\n  components:\n    a: {path: 'x y', empty: '', none: ~}\n  features: [f1, f2]\n  data: {}\n"));
+  const auto snapshot = yakka::ryml_snapshot(source["current"]);
+
+  ryml::Tree loaded;
+  loaded.rootref() |= ryml::MAP;
+  auto node = yakka::ryml_load_snapshot(snapshot, loaded.rootref());
+  ASSERT_TRUE(node.has_value());
+  EXPECT_EQ(node->key(), ryml::csubstr("current"));
+  EXPECT_EQ(ryml::emitrs_yaml<std::string>(loaded), ryml::emitrs_yaml<std::string>(source));
+}
+
+TEST(RymlSnapshotTest, RejectsTruncatedSnapshot)
+{
+  ryml::Tree source = ryml::parse_in_arena(ryml::to_csubstr("current: {a: 1, b: [1, 2]}"));
+  auto snapshot     = yakka::ryml_snapshot(source["current"]);
+  snapshot.resize(snapshot.size() - 1);
+
+  ryml::Tree loaded;
+  loaded.rootref() |= ryml::MAP;
+  EXPECT_FALSE(yakka::ryml_load_snapshot(snapshot, loaded.rootref()).has_value());
+  EXPECT_EQ(loaded.rootref().num_children(), 0);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "yakka_schema.hpp"
+#include <string>
+
+namespace {
+
+const std::string strategy_schema = R"(
+type: object
+properties:
+  high: {merge: max}
+  low: {merge: min}
+  joined: {merge: append}
+  sorted: {type: array, merge: sort}
+  unique: {type: array, merge: unique}
+  replaced: {type: array, merge: overwrite}
+  fixed: {merge: abort}
+  type: {merge: max}
+  nested:
+    type: object
+    additionalProperties: {merge: min}
+  list:
+    type: array
+    items: {type: object, properties: {size: {merge: max}}}
+)";
+
+std::string to_json(ryml::ConstNodeRef node)
+{
+  return ryml::emitrs_json<std::string>(node);
+}
+
+std::string normalized(const char *yaml)
+{
+  ryml::Tree tree = ryml::parse_in_arena(ryml::to_csubstr(yaml));
+  return to_json(tree.crootref());
+}
+
+// Merges each top-level entry of `source` into `destination` the way project data is merged
+bool merge_all(yakka::schema &schema, ryml::Tree &destination, const char *source_yaml)
+{
+  ryml::Tree source = ryml::parse_in_arena(ryml::to_csubstr(source_yaml));
+  bool result       = true;
+  for (const auto &entry: source.crootref().children()) {
+    const auto key = std::string{ entry.key().str, entry.key().len };
+    result &= schema.merge(destination[entry.key()], entry, ryml::Pointer("/" + key));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(SchemaMergeTest, MaxAndMinKeepTheNumericExtreme)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("high: 3\nlow: 3"));
+  EXPECT_TRUE(merge_all(schema, data, "high: 10\nlow: 10"));
+  EXPECT_TRUE(merge_all(schema, data, "high: 2\nlow: 2"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("high: 10\nlow: 2"));
+}
+
+TEST(SchemaMergeTest, AppendTurnsScalarsIntoSequence)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("joined: a"));
+  EXPECT_TRUE(merge_all(schema, data, "joined: b"));
+  EXPECT_TRUE(merge_all(schema, data, "joined: [c]"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("joined: [a, b, c]"));
+}
+
+TEST(SchemaMergeTest, SortAndUniqueReorderMergedSequences)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("sorted: [10, c]\nunique: [a, b]"));
+  EXPECT_TRUE(merge_all(schema, data, "sorted: [9, a]\nunique: [b, c, a]"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("sorted: [9, 10, a, c]\nunique: [a, b, c]"));
+}
+
+TEST(SchemaMergeTest, OverwriteReplacesExistingValue)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("replaced: [a, b]"));
+  EXPECT_TRUE(merge_all(schema, data, "replaced: [c]"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("replaced: [c]"));
+}
+
+TEST(SchemaMergeTest, AbortFailsOnConflictingValues)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("fixed: a"));
+  EXPECT_TRUE(merge_all(schema, data, "fixed: a"));
+  EXPECT_FALSE(merge_all(schema, data, "fixed: b"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("fixed: a"));
+}
+
+TEST(SchemaMergeTest, MembersNamedLikeKeywordsUseTheirPropertySchema)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("type: 2"));
+  EXPECT_TRUE(merge_all(schema, data, "type: 1"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("type: 2"));
+  EXPECT_EQ(schema.get_merge_strategy(ryml::Pointer("/type")), yakka::schema::merge_strategy::Max);
+}
+
+TEST(SchemaMergeTest, StrategiesApplyThroughAdditionalPropertiesAndItems)
+{
+  yakka::schema schema(strategy_schema);
+  ryml::Tree data = ryml::parse_in_arena(ryml::to_csubstr("nested: {x: 5}\nlist: [{size: 1}]"));
+  EXPECT_TRUE(merge_all(schema, data, "nested: {x: 7, y: 1}\nlist: [{size: 2}]"));
+  EXPECT_EQ(to_json(data.crootref()), normalized("nested: {x: 5, y: 1}\nlist: [{size: 1}, {size: 2}]"));
+  EXPECT_EQ(schema.get_merge_strategy(ryml::Pointer("/list/0/size")), yakka::schema::merge_strategy::Max);
+  EXPECT_EQ(schema.get_merge_strategy(ryml::Pointer("/nested/x")), yakka::schema::merge_strategy::Min);
+}
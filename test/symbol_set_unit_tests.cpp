@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "symbol_set.hpp"
+#include <string>
+#include <vector>
+
+TEST(SymbolSetTest, InternsNamesOnce)
+{
+  yakka::symbol_table symbols;
+  std::string name = "board";
+  const auto id    = symbols.intern(ryml::to_csubstr(name));
+  name             = "other";
+  EXPECT_EQ(symbols.intern(ryml::csubstr("board")), id);
+  EXPECT_EQ(symbols.name(id), ryml::csubstr("board"));
+  EXPECT_FALSE(symbols.find(ryml::csubstr("missing")).has_value());
+}
+
+TEST(SymbolSetTest, BehavesAsASet)
+{
+  yakka::symbol_table symbols;
+  yakka::symbol_set set(symbols);
+  EXPECT_TRUE(set.insert(ryml::csubstr("a")).second);
+  EXPECT_FALSE(set.insert(ryml::csubstr("a")).second);
+  set.insert(symbols.intern(ryml::csubstr("z")) + 100);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.contains(ryml::csubstr("a")));
+  EXPECT_FALSE(set.contains(ryml::csubstr("z")));
+  EXPECT_EQ(set.erase(ryml::csubstr("a")), 1);
+  EXPECT_EQ(set.erase(ryml::csubstr("a")), 0);
+  EXPECT_EQ(set.size(), 1);
+
+  auto moved = std::move(set);
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_EQ(moved.size(), 1);
+}
+
+TEST(SymbolSetTest, CombinesWordAtATime)
+{
+  yakka::symbol_table symbols;
+  for (int i = 0; i < 200; ++i)
+    symbols.intern(ryml::to_csubstr("s" + std::to_string(i)));
+
+  yakka::symbol_set required(symbols), provided(symbols);
+  for (const auto *name: { "s1", "s70", "s150" })
+    required.insert(ryml::to_csubstr(name));
+  provided.insert(ryml::csubstr("s70"));
+  EXPECT_FALSE(provided.includes(required));
+
+  required -= provided;
+  std::vector<std::string> names;
+  for (const auto n: required)
+    names.emplace_back(n.str, n.len);
+  EXPECT_EQ(names, (std::vector<std::string>{ "s1", "s150" }));
+
+  provided |= required;
+  EXPECT_EQ(provided.size(), 3);
+  EXPECT_TRUE(provided.includes(required));
+}
@@ -0,0 +1,209 @@
+/**
+ * @file affected.cpp
+ * @brief Implements the query for projects and targets affected by changed files.
+ */
+
+#include "affected.hpp"
+#include "yakka.hpp"
+#include "dependency_log.hpp"
+#include "ryml_snapshot.hpp"
+#include "utilities.hpp"
+#include "spdlog/spdlog.h"
+#include "taskflow.hpp"
+#include "algorithm/for_each.hpp"
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace yakka {
+
+namespace {
+
+/// @brief Executes view.
+
+std::string_view view(ryml::csubstr s)
+{
+  return { s.str, s.len };
+}
+
+} // namespace
+
+/// @brief Executes workspace_relative_path.
+
+std::string workspace_relative_path(std::string_view path, const fs::path &workspace_path)
+{
+  fs::path p = fs::path(path).lexically_normal();
+
+  if (p.is_absolute()) {
+    const auto relative = p.lexically_relative(workspace_path);
+    if (!relative.empty() && *relative.begin() != "..")
+      p = relative;
+  }
+  return p.generic_string();
+}
+
+/// @brief Executes find_affected_targets.
+
+std::optional<affected_project> find_affected_targets(const fs::path &project_output, const std::vector<std::string> &changed_files)
+{
+  affected_project project{ project_output.filename().string() };
+
+  // Paths written by blueprints and depfiles may be absolute or start with "./"
+  const auto workspace_prefix = fs::current_path().generic_string() + "/";
+  const auto trim             = [&](std::string_view path) {
+    if (path.starts_with(workspace_prefix))
+      path.remove_prefix(workspace_prefix.size());
+    while (path.starts_with("./"))
+      path.remove_prefix(2);
+    return path;
+  };
+  const std::unordered_set<std::string_view> changed(changed_files.begin(), changed_files.end());
+
+  // The summary lists the files the evaluation read. The snapshot is loaded without parsing.
+  mapped_file summary_snapshot;
+  ryml::Tree summary_tree;
+  ryml::ConstNodeRef summary;
+  summary_tree.rootref() |= ryml::MAP;
+  if (is_up_to_date(project_output / project_snapshot_filename, project_output / project_summary_filename) && summary_snapshot.open(project_output / project_snapshot_filename)) {
+    if (auto loaded = ryml_load_snapshot(summary_snapshot.contents(), summary_tree.rootref()))
+      summary = loaded.value();
+  }
+  if (!summary.valid()) {
+    auto loaded = ryml_load_file(project_output / project_summary_filename);
+    if (!loaded) {
+      spdlog::debug("No summary in {}", project_output.generic_string());
+      return std::nullopt;
+    }
+    summary_tree = std::move(loaded.value());
+    summary      = summary_tree.crootref();
+  }
+  if (!summary.is_map())
+    return std::nullopt;
+
+  if (summary.has_child("project_name") && summary["project_name"].has_val())
+    project.name = ryml_string(summary["project_name"].val());
+  if (summary.has_child("project_file") && summary["project_file"].has_val() && changed.contains(trim(view(summary["project_file"].val()))))
+    project.rebuild_all = true;
+  if (summary.has_child("components"))
+    for (const auto &c: summary["components"].children())
+      if (c.is_map() && c.has_child("yakka_file") && c["yakka_file"].has_val() && changed.contains(trim(view(c["yakka_file"].val()))))
+        project.rebuild_all = true;
+
+  mapped_file graph_snapshot;
+  ryml::Tree graph_tree;
+  graph_tree.rootref() |= ryml::SEQ;
+  ryml::ConstNodeRef graph;
+  if (graph_snapshot.open(project_output / target_graph_filename)) {
+    if (auto loaded = ryml_load_snapshot(graph_snapshot.contents(), graph_tree.rootref()))
+      graph = loaded.value();
+  }
+  if (!graph.valid() || !graph.is_map()) {
+    // Nothing has been built, so every target is outstanding
+    project.rebuild_all = true;
+    return project;
+  }
+
+  if (project.rebuild_all) {
+    for (const auto &target: graph.children())
+      project.targets.push_back(ryml_string(target.key()));
+    return project;
+  }
+
+  // Depfile dependencies complete the graph. Without a log only the blueprint dependencies are known.
+  dependency_log log;
+  if (fs::exists(project_output / dependency_log_filename) && !log.load(project_output / dependency_log_filename))
+    spdlog::debug("Ignoring unreadable dependency log in {}", project_output.generic_string());
+
+  // Changed files as recorded in the log, which holds them either relative to the workspace or absolute
+  std::unordered_set<dependency_log::path_id> changed_ids;
+  for (const auto &f: changed_files)
+    for (const auto &path: { f, workspace_prefix + f })
+      if (const auto id = log.find_path(path))
+        changed_ids.insert(id.value());
+
+  std::vector<ryml::ConstNodeRef> targets;
+  std::unordered_map<std::string_view, size_t> target_ids;
+  for (const auto &target: graph.children()) {
+    target_ids.emplace(view(target.key()), targets.size());
+    targets.push_back(target);
+  }
+
+  // A target is affected when one of its dependencies changed or is itself an affected target. Targets that depend
+  // directly on a changed file start the search, which then follows each dependency edge in reverse once.
+  std::vector<std::vector<size_t>> dependents(targets.size());
+  std::vector<bool> affected(targets.size(), false);
+  std::vector<size_t> pending;
+  for (size_t id = 0; id < targets.size(); ++id) {
+    const auto target = targets[id];
+    bool changed_input = false;
+    if (target.has_child("depfiles") && !changed_ids.empty())
+      for (const auto &f: target["depfiles"].children())
+        if (const auto *record = log.find(view(f.val())))
+          changed_input = changed_input || std::ranges::any_of(record->dependencies, [&](auto d) {
+                            return changed_ids.contains(d);
+                          });
+    if (target.has_child("dependencies"))
+      for (const auto &d: target["dependencies"].children()) {
+        const auto dependency = view(d.val());
+        if (changed.contains(trim(dependency)))
+          changed_input = true;
+        if (auto it = target_ids.find(dependency); it != target_ids.end())
+          dependents[it->second].push_back(id);
+      }
+    if (changed_input) {
+      affected[id] = true;
+      pending.push_back(id);
+    }
+  }
+
+  while (!pending.empty()) {
+    const auto id = pending.back();
+    pending.pop_back();
+    for (const auto dependent: dependents[id])
+      if (!affected[dependent]) {
+        affected[dependent] = true;
+        pending.push_back(dependent);
+      }
+  }
+
+  for (size_t id = 0; id < targets.size(); ++id)
+    if (affected[id])
+      project.targets.push_back(ryml_string(targets[id].key()));
+
+  if (project.targets.empty())
+    return std::nullopt;
+  std::ranges::sort(project.targets);
+  return project;
+}
+
+/// @brief Executes find_affected_projects.
+
+std::vector<affected_project> find_affected_projects(const fs::path &output_directory, const std::vector<std::string> &changed_files)
+{
+  std::vector<fs::path> outputs;
+
+  std::error_code ec;
+  for (const auto &entry: fs::directory_iterator(output_directory, ec))
+    if (entry.is_directory(ec) && (fs::exists(entry.path() / project_snapshot_filename, ec) || fs::exists(entry.path() / project_summary_filename, ec)))
+      outputs.push_back(entry.path());
+
+  std::vector<std::optional<affected_project>> results(outputs.size());
+  tf::Executor executor(std::min(32U, std::thread::hardware_concurrency()));
+  tf::Taskflow taskflow;
+  taskflow.for_each_index(size_t{ 0 }, outputs.size(), size_t{ 1 }, [&](size_t i) {
+    results[i] = find_affected_targets(outputs[i], changed_files);
+  });
+  executor.run(taskflow).wait();
+
+  std::vector<affected_project> projects;
+  for (auto &r: results)
+    if (r)
+      projects.push_back(std::move(r.value()));
+  std::ranges::sort(projects, {}, &affected_project::name);
+  return projects;
+}
+
+} // namespace yakka
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace yakka {
+
+/**
+ * @brief Projects and targets affected by a set of changed files.
+ *
+ * The query reads what previous builds persisted in each project output directory: the summary for
+ * the files the evaluation depends on, the target graph and the dependency log for the files each
+ * target is built from. No project is evaluated.
+ */
+struct affected_project {
+  std::string name;
+  bool rebuild_all = false;         // The evaluation inputs changed or the project has no target graph yet
+  std::vector<std::string> targets; // Affected targets, sorted
+};
+
+// Converts a path to the form used by targets: relative to the workspace when inside it, with '/' separators
+std::string workspace_relative_path(std::string_view path, const std::filesystem::path &workspace_path);
+
+// Returns the project in `project_output` if any of `changed_files` (workspace relative) affects it
+std::optional<affected_project> find_affected_targets(const std::filesystem::path &project_output, const std::vector<std::string> &changed_files);
+
+// Queries every project found in `output_directory` in parallel
+std::vector<affected_project> find_affected_projects(const std::filesystem::path &output_directory, const std::vector<std::string> &changed_files);
+
+} // namespace yakka
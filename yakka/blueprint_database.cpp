@@ -13,10 +13,48 @@
 #include <regex>
 
 namespace yakka {
+
+/// @brief Executes for_each_list_item.
+
+// Splits a rendered flow sequence such as `[a.o, b.o, ]` into its items without a YAML parser.
+// Items may be single or double quoted; empty items (e.g. a trailing comma) are skipped.
+template <typename Function>
+static void for_each_list_item(std::string_view list, Function &&function)
+{
+  list.remove_prefix(1);
+  list.remove_suffix(1);
+
+  constexpr std::string_view whitespace = " \t\r\n";
+  while (!list.empty()) {
+    const auto start = list.find_first_not_of(whitespace);
+    if (start == std::string_view::npos)
+      break;
+    list.remove_prefix(start);
+
+    std::string_view item;
+    if (list.front() == '"' || list.front() == '\'') {
+      const auto end = list.find(list.front(), 1);
+      item           = list.substr(1, end == std::string_view::npos ? std::string_view::npos : end - 1);
+      list.remove_prefix(end == std::string_view::npos ? list.size() : end + 1);
+      const auto separator = list.find(',');
+      list.remove_prefix(separator == std::string_view::npos ? list.size() : separator + 1);
+    } else {
+      const auto separator = list.find(',');
+      item                 = list.substr(0, separator);
+      list.remove_prefix(separator == std::string_view::npos ? list.size() : separator + 1);
+      const auto last = item.find_last_not_of(whitespace);
+      item            = item.substr(0, last == std::string_view::npos ? 0 : last + 1);
+    }
+
+    if (!item.empty())
+      function(item);
+  }
+}
+
 blueprint_database::blueprint_database()
 {
-  database.reserve_arena(8 * 1024 * 1024);                // Reserve 8MB to keep csubstr-backed arena storage stable during typical operations.
-  database.add_flags(ryml::Tree::TREEF_NO_ARENA_REALLOC); // Forbid arena reallocations to ensure pointer stability of csubstrs.
+  database.reserve_arena(yakka::blueprint_arena_chunk_size);                                 // Reserve the first arena chunk for matches and dependencies.
+  database.add_flags(ryml::Tree::TREEF_NO_ARENA_REALLOC | ryml::Tree::TREEF_CHUNKED_ARENA); // Grow by adding chunks to ensure pointer stability of csubstrs.
   database.rootref() |= ryml::MAP;
   database["blueprints"] |= ryml::SEQ;
   database["matches"] |= ryml::SEQ;
@@ -80,7 +118,22 @@ std::vector<std::shared_ptr<blueprint_match>> blueprint_database::find_match(rym
 /// @brief Executes add_callback.
 
     local_inja_env.add_callback("render", 1, [&](inja::Arguments &args, ryml::NodeRef additional_data) {
-      return additional_data["values"].append_child() << local_inja_env.render(args[0].val<std::string>().value(), project_summary);
+      return additional_data["values"].append_child() << yakka::render_cached(local_inja_env, args[0].val<std::string>().value(), project_summary);
+    });
+
+    // Adds a dependency for every matched input without building an intermediate list string
+    auto add_dependency = [&](std::string_view name) {
+      if (name.starts_with("./"))
+        name.remove_prefix(std::min(name.find_first_not_of('/', 2), name.size()));
+      auto dependency = database["dependencies"].append_child() << ryml::csubstr(name.data(), name.size());
+      match->dependencies.push_back(dependency.val());
+    };
+
+/// @brief Executes add_callback.
+
+    local_inja_env.add_callback("add_dependency", 1, [&](inja::Arguments &args, ryml::NodeRef additional_data) {
+      add_dependency(std::string_view(args[0].val().data(), args[0].val().size()));
+      return additional_data["values"].append_child() << "";
     });
 
 /// @brief Executes add_callback.
@@ -120,9 +173,9 @@ std::vector<std::shared_ptr<blueprint_match>> blueprint_database::find_match(rym
             aggregate[i.key()] = i.val(); //local_inja_env.render(i.second.as<std::string>(), this->project_summary);
         else if (v.is_seq())
           for (const auto &i: v.children())
-            aggregate.append_child() << local_inja_env.render(i.val<std::string>().value(), project_summary);
+            aggregate.append_child() << yakka::render_cached(local_inja_env, i.val<std::string>().value(), project_summary);
         else
-          aggregate.append_child() << local_inja_env.render(v.val<std::string>().value(), project_summary);
+          aggregate.append_child() << yakka::render_cached(local_inja_env, v.val<std::string>().value(), project_summary);
       }
 
       // Check project data
@@ -133,9 +186,9 @@ std::vector<std::shared_ptr<blueprint_match>> blueprint_database::find_match(rym
             aggregate[i.key()] = i.val();
         else if (v.is_seq())
           for (const auto &i: v.children())
-            aggregate.append_child() << local_inja_env.render(i.val<std::string>().value(), project_summary);
+            aggregate.append_child() << yakka::render_cached(local_inja_env, i.val<std::string>().value(), project_summary);
         else
-          aggregate.append_child() << local_inja_env.render(v.val<std::string>().value(), project_summary);
+          aggregate.append_child() << yakka::render_cached(local_inja_env, v.val<std::string>().value(), project_summary);
       }
       return aggregate;
     });
@@ -147,6 +200,8 @@ std::vector<std::shared_ptr<blueprint_match>> blueprint_database::find_match(rym
           const std::string generated_dependency_file = yakka::try_render(local_inja_env, d.name, project_summary);
           auto dependencies                           = parse_gcc_dependency_file(generated_dependency_file);
           match->dependencies.insert(std::end(match->dependencies), std::begin(dependencies), std::end(dependencies));
+          if (match->depfile.empty())
+            match->depfile = generated_dependency_file;
           continue;
         }
         case blueprint::dependency::DATA_DEPENDENCY: {
@@ -164,29 +219,28 @@ std::vector<std::shared_ptr<blueprint_match>> blueprint_database::find_match(rym
       // Generate full dependency string by applying template engine
       std::string generated_depend;
       try {
-        generated_depend = local_inja_env.render(std::string_view(d.name.data(), d.name.size()), project_summary);
+        generated_depend = yakka::render_cached(local_inja_env, std::string_view(d.name.data(), d.name.size()), project_summary);
       } catch (std::exception &e) {
         spdlog::error("Error evaluating dependency for {}\r\nCouldn't apply template: '{}'\n{}", blueprint.first, d.name, e.what());
         return result;
       }
 
-      // Check if the input was a YAML array construct
-      if (generated_depend.front() == '[' && generated_depend.back() == ']') {
-        // Load the generated dependency string as YAML and push each item individually
-        try {
-          auto generated_node = YAML::Load(generated_depend);
-          for (auto i: generated_node) {
-            auto temp       = i.Scalar();
-            auto dependency = database["dependencies"].append_child() << (temp.starts_with("./") ? temp.substr(temp.find_first_not_of("/", 2)) : temp);
-            match->dependencies.push_back(dependency.val());
-          }
-        } catch (std::exception &e) {
-          std::cerr << "Failed to parse dependency: " << ryml_string(d.name) << "\n";
-        }
-      } else {
-        auto dependency = database["dependencies"].append_child() << (generated_depend.starts_with("./") ? generated_depend.substr(generated_depend.find_first_not_of("/", 2)) : generated_depend);
-        match->dependencies.push_back(dependency.val());
-      }
+      // Dependencies emitted through add_dependency() leave nothing behind
+      if (generated_depend.find_first_not_of(" \t\r\n") == std::string::npos)
+        continue;
+
+      // Check if the input was a YAML flow sequence and push each item individually
+      if (generated_depend.front() == '[' && generated_depend.back() == ']')
+        for_each_list_item(generated_depend, add_dependency);
+      else
+        add_dependency(generated_depend);
+    }
+
+    // Dependencies recorded from the depfile the process emitted on a previous run
+    if (blueprint.second->depfile.has_value()) {
+      match->depfile    = yakka::try_render(local_inja_env, blueprint.second->depfile.value(), project_summary);
+      auto dependencies = parse_gcc_dependency_file(match->depfile);
+      match->dependencies.insert(std::end(match->dependencies), std::begin(dependencies), std::end(dependencies));
     }
 
     result.push_back(match);
@@ -225,6 +279,8 @@ void blueprint_database::save(const std::filesystem::path filename)
     blueprint["target"] << bp.second->target;
     blueprint["regex"] << bp.second->regex.value_or("");
     blueprint["parent_path"] << bp.second->parent_path;
+    if (bp.second->depfile.has_value())
+      blueprint["depfile"] << bp.second->depfile.value();
 
     auto dependencies = blueprint.append_child() << ryml::Key("dependencies");
     dependencies |= ryml::SEQ;
@@ -236,8 +292,7 @@ void blueprint_database::save(const std::filesystem::path filename)
     }
   }
 
-  std::ofstream file(filename);
-  file << ryml::emitrs_json<std::string>(output);
+  save_file_if_changed(filename, ryml::emitrs_json<std::string>(output));
 }
 
 /**
@@ -251,36 +306,8 @@ void blueprint_database::save(const std::filesystem::path filename)
  */
 std::vector<ryml::csubstr> blueprint_database::parse_gcc_dependency_file(const std::string &filename)
 {
-  std::vector<ryml::csubstr> dependencies;
-  std::ifstream infile(filename);
-
-  if (!infile.is_open())
-    return {};
-
-  std::string line;
-
-  // Find and ignore the first line with the target. Typically "<target>: \"
-  do {
-    std::getline(infile, line);
-  } while (line.length() > 0 && line.find(':') == std::string::npos);
-
-  while (std::getline(infile, line, ' ')) {
-    if (line.empty() || line.compare("\\\n") == 0)
-      continue;
-    if (line.back() == '\n')
-      line.pop_back();
-    if (line.back() == '\r')
-      line.pop_back();
-    if (line.rfind("./", 0) == 0) {
-      auto dependency = database["dependencies"].append_child() << line.substr(2);
-      dependencies.push_back(dependency.val());
-    } else {
-      auto dependency = database["dependencies"].append_child() << line;
-      dependencies.push_back(dependency.val());
-    }
-  }
-
-  return dependencies;
+  // Paths are interned by the dependency log so shared headers are stored once for every object
+  return dependency_log.get_dependencies(filename);
 }
 
 /// @brief Executes create_blueprint.
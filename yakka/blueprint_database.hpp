@@ -1,6 +1,7 @@
 #pragma once
 
 #include "yakka_blueprint.hpp"
+#include "dependency_log.hpp"
 #include <ryml.hpp>
 #include <ryml_std.hpp>
 #include <string>
@@ -14,6 +15,7 @@ struct blueprint_match {
   std::vector<ryml::csubstr> dependencies; // Template processed dependencies
   std::shared_ptr<yakka::blueprint> blueprint;
   std::vector<ryml::csubstr> regex_matches; // Regex capture groups for a particular regex match
+  std::string depfile;                      // Rendered dependency file ingested after the process runs
 };
 
 class blueprint_database {
@@ -33,6 +35,7 @@ public:
 
   ryml::Tree database;
   std::multimap<c4::csubstr, std::shared_ptr<blueprint>> blueprints;
+  yakka::dependency_log dependency_log; // Interned depfile dependencies, persisted between runs
 };
 
 } // namespace yakka
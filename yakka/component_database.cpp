@@ -13,9 +13,19 @@
 #include <c4/yml/emit.hpp>
 #include "utilities.hpp"
 #include "yakka.hpp"
+#include "taskflow.hpp"
+#include "algorithm/for_each.hpp"
 #include <ranges>
 #include <format>
 #include <fstream>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#if !defined(_WIN64) && !defined(_WIN32) && !defined(__CYGWIN__)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
 
 namespace yakka {
 
@@ -54,6 +64,148 @@ std::string component_id_from_path(const fs::path &path)
   return path.stem().string();
 }
 
+/// @brief Executes is_scanned_file.
+
+bool is_scanned_file(const fs::path &path)
+{
+  const auto extension = path.extension();
+
+  return is_yakka_component_file(path) || extension == slcc_component_extension || extension == slcp_component_extension;
+}
+
+// Files parsed in parallel before they are indexed in order, which bounds the parsed trees held at once
+constexpr size_t scan_batch_size = 256;
+
+// Written to each database and bumped when indexing records something older databases lack, such as `metadata`
+constexpr int database_format = 2;
+
+// A component file found by the scan. Scalars of a YAML tree are views into its contents.
+struct scanned_file {
+  fs::path path;
+  std::vector<char> contents;
+  ryml::Tree tree;
+  bool parsed = false;
+};
+
+/**
+ * @brief Finds component files below a directory with one task per directory.
+ *
+ * Entry types come from the directory listing, so only symbolic links and file systems that do not
+ * report a type need a stat. Symbolic links to directories are not followed.
+ */
+class directory_walker {
+public:
+  directory_walker(const fs::path &root, const std::vector<std::string> &ignore) : root(root)
+  {
+    for (const auto &i: ignore)
+      if (i.starts_with('/'))
+        ignored_paths.push_back(i.substr(1));
+      else
+        (i.find('/') == std::string::npos ? ignored_names : ignored_paths).push_back(i);
+  }
+
+  /// @brief Executes walk.
+
+  // `relative` is the path of `directory` from the root, empty for the root itself
+  void walk(tf::Subflow &subflow, const fs::path &directory, const std::string &relative)
+  {
+    std::vector<fs::path> files;
+
+    const auto visit_directory = [&](const std::string &name) {
+      const auto child_relative = relative.empty() ? name : relative + "/" + name;
+      if (std::ranges::find(ignored_names, name) != ignored_names.end() || std::ranges::find(ignored_paths, child_relative) != ignored_paths.end())
+        return;
+      subflow.emplace([this, child = directory / name, child_relative](tf::Subflow &child_subflow) {
+        walk(child_subflow, child, child_relative);
+      });
+    };
+    const auto visit_file = [&](const std::string &name) {
+      if (name.front() == '.')
+        return;
+      auto path = directory / name;
+      if (is_scanned_file(path))
+        files.push_back(std::move(path));
+    };
+
+#if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
+    // Directory entries on Windows carry their attributes, so these checks do not touch the file system
+    std::error_code ec;
+    for (const auto &entry: fs::directory_iterator(directory, ec)) {
+      const auto name = entry.path().filename().string();
+      if (!entry.is_symlink(ec) && entry.is_directory(ec))
+        visit_directory(name);
+      else if (entry.is_regular_file(ec))
+        visit_file(name);
+    }
+#else
+    DIR *dir = ::opendir(directory.c_str());
+    if (dir == nullptr) {
+      spdlog::debug("Skipping unreadable directory {}", directory.string());
+      return;
+    }
+    while (const dirent *entry = ::readdir(dir)) {
+      const std::string name = entry->d_name;
+      if (name == "." || name == "..")
+        continue;
+
+      auto type = entry->d_type;
+      if (type == DT_UNKNOWN || type == DT_LNK) {
+        struct stat entry_stat;
+        const auto entry_path = directory / name;
+        const int result      = type == DT_LNK ? ::stat(entry_path.c_str(), &entry_stat) : ::lstat(entry_path.c_str(), &entry_stat);
+        if (result != 0)
+          continue;
+        if (S_ISREG(entry_stat.st_mode))
+          type = DT_REG;
+        else if (S_ISDIR(entry_stat.st_mode) && type == DT_UNKNOWN)
+          type = DT_DIR;
+      }
+      if (type == DT_DIR)
+        visit_directory(name);
+      else if (type == DT_REG)
+        visit_file(name);
+    }
+    ::closedir(dir);
+#endif
+
+    if (files.empty())
+      return;
+    std::lock_guard lock(found_mutex);
+    std::ranges::move(files, std::back_inserter(found));
+  }
+
+  fs::path root;
+  std::vector<fs::path> found;
+
+private:
+  std::vector<std::string> ignored_names;
+  std::vector<std::string> ignored_paths;
+  std::mutex found_mutex;
+};
+
+/// @brief Executes copy_to_arena.
+
+// Deep copies `src` below `dst`, copying every scalar into the arena of the destination tree
+void copy_to_arena(ryml::NodeRef dst, ryml::ConstNodeRef src)
+{
+  if (src.is_map())
+
+    dst |= ryml::MAP;
+  else if (src.is_seq())
+    dst |= ryml::SEQ;
+  else if (src.has_val())
+    dst << src.val();
+
+  for (const auto &child: src.children()) {
+    auto new_child = dst.append_child();
+    if (child.has_key()) {
+      const auto key = child.key();
+      new_child << ryml::key(key);
+    }
+    copy_to_arena(new_child, child);
+  }
+}
+
 } // namespace
 
 /// @brief Executes initialize_database.
@@ -76,6 +228,8 @@ static void initialize_database(ryml::Tree &database)
   ensure_map("features");
   ensure_map("types");
   ensure_map("serve");
+  ensure_map("metadata");
+  root.append_child() << ryml::key("format") << database_format;
 }
 
 // Constructor initializes empty database with default values
@@ -137,6 +291,16 @@ std::expected<void, error> component_database::load(const path &workspace_path)
         return save();
       }
       database = std::move(*loaded);
+      int format = 0;
+      if (database.rootref().has_child("format"))
+        database["format"] >> format;
+      if (format != database_format) {
+        // Indexing only reads new files, so entries from an older format would never be completed
+        spdlog::info("Rebuilding component database at {}", this->workspace_path.string());
+        clear();
+        scan_for_components(this->workspace_path);
+        return save();
+      }
     }
     return {};
   } catch (const std::exception &e) {
@@ -151,8 +315,9 @@ std::expected<void, error> component_database::save() const
 {
   try {
 
-    std::ofstream ofs(database_filename);
-    ofs << ryml::emitrs_json<std::string>(database);
+    auto result = save_file_if_changed(database_filename, ryml::emitrs_json<std::string>(database));
+    if (!result)
+      return std::unexpected(result.error());
     return {};
   } catch (const std::exception &) {
     return std::unexpected(std::make_error_code(std::errc::io_error));
@@ -234,42 +399,77 @@ void component_database::scan_for_components(std::optional<path> search_start_pa
     return;
   }
 
-  const auto process_entry = [this](const fs::directory_entry &entry) {
-    const auto &path     = entry.path();
-    const auto ext       = path.extension();
-    const auto id        = component_id_from_path(path);
-    const auto id_substr = c4::to_csubstr(id);
-
-    if (auto result = add_component(id, path); result && *result) {
-      if (is_yakka_component_file(path)) {
-        parse_yakka_file(path, id_substr);
-      } else if (ext == slcc_component_extension) {
-        spdlog::info("Found {}", path.string());
-        parse_slcc_file(path);
-      } else if (ext == slcp_component_extension) {
-        spdlog::info("Found project '{}'", path.string());
-        // parse_slcp_file(path);
-      }
+  tf::Executor executor(std::min(32U, std::thread::hardware_concurrency()));
+  directory_walker walker(scan_path, scan_ignore);
+  tf::Taskflow taskflow;
+  taskflow.emplace([&](tf::Subflow &subflow) {
+    walker.walk(subflow, scan_path, "");
+  });
+  executor.run(taskflow).wait();
+
+  // Files are indexed in path order so the database does not depend on the order the tasks ran in.
+  // Files that are already indexed are dropped first so they are not read and parsed again.
+  std::unordered_set<std::string> indexed;
+  for (const auto &entries: database["components"].children())
+    if (entries.is_seq())
+      for (const auto &entry: entries.children())
+        indexed.insert(ryml_string(entry.val()));
+    else if (entries.has_val())
+      indexed.insert(ryml_string(entries.val()));
+  std::erase_if(walker.found, [&](const fs::path &p) {
+    return indexed.contains(fs::absolute(p).generic_string());
+  });
+  std::ranges::sort(walker.found);
+
+  const auto parse_file = [](scanned_file &file) {
+    if (file.path.extension() == slcp_component_extension)
+      return;
+    auto contents = yakka::get_file_contents<std::vector<char>>(file.path.string());
+    if (!contents)
+      return;
+    file.contents = std::move(contents.value());
+    try {
+      if (has_component_toml_extension(file.path))
+        file.tree = toml_ryml::parse_toml(std::string_view(file.contents.data(), file.contents.size()), file.path.generic_string());
+      else
+        file.tree = ryml::parse_in_place(ryml::to_substr(file.contents));
+      file.parsed = true;
+    } catch (const std::exception &e) {
+      spdlog::error("Failed to parse {}: {}", file.path.string(), e.what());
     }
   };
 
-/// @brief Executes recursive_directory_iterator.
-
-  auto entries = fs::recursive_directory_iterator(scan_path) | std::views::filter([](const auto &e) {
-                   std::error_code ec;
-                   fs::perms permissions = fs::status(e.path()).permissions();
-
-                   if ((permissions & fs::perms::owner_read) == fs::perms::none) {
-                     return false;
-                   }
-                   return e.exists(ec) && !e.is_directory() && e.path().filename().string().front() != '.'
-                          && (is_yakka_component_file(e.path()) || e.path().extension() == yakka::slcc_component_extension
-                              || e.path().extension() == yakka::slcp_component_extension);
-                 });
-  try {
-    std::ranges::for_each(entries, process_entry);
-  } catch (const std::filesystem::filesystem_error &e) {
-    spdlog::error("Error scanning for components: {}. See '{}'", e.what(), e.path1().string());
+  std::vector<scanned_file> batch;
+  for (size_t start = 0; start < walker.found.size(); start += scan_batch_size) {
+    const size_t end = std::min(start + scan_batch_size, walker.found.size());
+    batch.clear();
+    batch.resize(end - start);
+    for (size_t i = start; i < end; ++i)
+      batch[i - start].path = std::move(walker.found[i]);
+
+    tf::Taskflow parse_taskflow;
+    parse_taskflow.for_each(batch.begin(), batch.end(), parse_file);
+    executor.run(parse_taskflow).wait();
+
+    for (auto &file: batch) {
+      const auto ext       = file.path.extension();
+      const auto id        = component_id_from_path(file.path);
+      const auto id_substr = c4::to_csubstr(id);
+
+      if (auto result = add_component(id, file.path); result && *result) {
+        if (is_yakka_component_file(file.path)) {
+          if (file.parsed)
+            index_yakka_file(file.path, id_substr, file.tree.crootref());
+        } else if (ext == slcc_component_extension) {
+          spdlog::info("Found {}", file.path.string());
+          if (file.parsed)
+            index_slcc_file(file.path, file.tree.crootref());
+        } else if (ext == slcp_component_extension) {
+          spdlog::info("Found project '{}'", file.path.string());
+          // parse_slcp_file(path);
+        }
+      }
+    }
   }
   has_scanned = true;
 }
@@ -337,6 +537,22 @@ std::expected<path, error> component_database::get_component(ryml::csubstr id, f
   return {};
 }
 
+/// @brief Executes get_component_metadata.
+
+std::optional<ryml::ConstNodeRef> component_database::get_component_metadata(const path &component_file) const
+{
+  const auto root = database.crootref();
+
+  if (!root.has_child("metadata"))
+    return std::nullopt;
+
+  const auto path_string = component_file.generic_string();
+  const auto metadata    = root["metadata"];
+  if (!metadata.has_child(c4::to_csubstr(path_string)))
+    return std::nullopt;
+  return metadata[c4::to_csubstr(path_string)];
+}
+
 /// @brief Executes get_component_id.
 
 std::expected<std::string, error> component_database::get_component_id(const path &path) const
@@ -364,6 +580,33 @@ std::expected<std::string, error> component_database::get_component_id(const pat
   return std::unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
 }
 
+/// @brief Executes get_component_files.
+
+std::vector<path> component_database::get_component_files(const path &directory, std::string_view extension) const
+{
+  std::vector<path> files;
+  auto prefix = fs::absolute(directory).lexically_normal().generic_string();
+  if (!prefix.ends_with('/'))
+    prefix += '/';
+
+  const auto add_entry = [&](ryml::ConstNodeRef entry) {
+    if (!entry.has_val())
+      return;
+    const auto file = (this->workspace_path / std::filesystem::path{ entry.val<std::string>().value() }).lexically_normal();
+    if (file.extension() == extension && file.generic_string().starts_with(prefix))
+      files.push_back(file);
+  };
+
+  for (const auto &entry: database["components"].children()) {
+    if (entry.is_seq())
+      for (const auto &n: entry.children())
+        add_entry(n);
+    else
+      add_entry(entry);
+  }
+  return files;
+}
+
 /// @brief Executes get_blueprint_provider.
 
 std::optional<ryml::ConstNodeRef> component_database::get_blueprint_provider(ryml::csubstr blueprint) const
@@ -405,8 +648,14 @@ std::expected<void, std::error_code> component_database::parse_yakka_file(const
   } else {
     tree = ryml::parse_in_place(ryml::to_substr(*result));
   }
-  auto root       = tree.crootref();
+  index_yakka_file(path, id, tree.crootref());
+  return {};
+}
+
+/// @brief Executes index_yakka_file.
 
+void component_database::index_yakka_file(const path &path, ryml::csubstr id, ryml::ConstNodeRef root)
+{
   // Check for blueprints and process them
   if (root.has_child("blueprints")) {
     for (const auto &b: root["blueprints"].children()) {
@@ -440,7 +689,23 @@ std::expected<void, std::error_code> component_database::parse_yakka_file(const
     }
   }
 
-  return {};
+  // Record what dependency resolution needs so it can plan without parsing the component
+  auto database_root = database.rootref();
+  if (!database_root.has_child("metadata")) {
+    auto metadata_node = database_root.append_child() << ryml::key("metadata");
+    metadata_node |= ryml::MAP;
+  }
+  // A file indexed again replaces its previous entry
+  const auto path_string = fs::absolute(path).generic_string();
+  auto metadata_root     = database_root["metadata"];
+  if (metadata_root.has_child(c4::to_csubstr(path_string)))
+    metadata_root.remove_child(c4::to_csubstr(path_string));
+  auto metadata = metadata_root.append_child();
+  metadata.set_key_serialized(c4::to_csubstr(path_string));
+  metadata |= ryml::MAP;
+  for (const ryml::csubstr key: { "requires", "provides", "supports", "replaces", "choices" })
+    if (root.has_child(key))
+      copy_to_arena(metadata.append_child() << ryml::key(key), root[key]);
 }
 
 /// @brief Executes get_feature_provider.
@@ -467,8 +732,17 @@ std::expected<void, std::error_code> component_database::parse_slcc_file(const p
       return std::unexpected(file_content.error());
     }
     ryml::Tree tree = ryml::parse_in_place(ryml::to_substr(*file_content));
-    auto root       = tree.crootref();
+    return index_slcc_file(path, tree.crootref());
+  } catch (const std::exception &) {
+    return std::unexpected(std::make_error_code(std::errc::io_error));
+  }
+}
+
+/// @brief Executes index_slcc_file.
 
+std::expected<void, std::error_code> component_database::index_slcc_file(const path &path, ryml::ConstNodeRef root)
+{
+  try {
     c4::yml::ConstNodeRef id_node;
     c4::yml::ConstNodeRef provides_node;
     c4::yml::ConstNodeRef blueprint_node;
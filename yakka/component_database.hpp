@@ -2,9 +2,12 @@
 
 #include <ryml.hpp>
 #include <ryml_std.hpp>
+#include "yakka.hpp"
 #include <filesystem>
 #include <expected>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace yakka {
 
@@ -51,6 +54,12 @@ public:
 
   [[nodiscard]] std::expected<std::string, std::error_code> get_component_id(const path &path) const;
 
+  // Resolution metadata ('requires', 'provides', 'supports', 'replaces' and 'choices') recorded for a component file at scan time
+  [[nodiscard]] std::optional<ryml::ConstNodeRef> get_component_metadata(const path &component_file) const;
+
+  // Indexed component files located under `directory` with the given extension
+  [[nodiscard]] std::vector<path> get_component_files(const path &directory, std::string_view extension) const;
+
   // Return optional for queries that might not find a result
   [[nodiscard]] std::optional<ryml::ConstNodeRef> get_feature_provider(ryml::csubstr feature) const;
   [[nodiscard]] std::optional<ryml::ConstNodeRef> get_blueprint_provider(ryml::csubstr blueprint) const;
@@ -67,6 +76,12 @@ public:
     return this->has_scanned;
   }
 
+  // True when the index has changes that are not saved yet
+  [[nodiscard]] bool is_dirty() const noexcept
+  {
+    return this->database_is_dirty;
+  }
+
   // Add ability to dump the database for debugging
   std::string dump() const
   {
@@ -74,7 +89,15 @@ public:
   }
 
   ryml::Tree database;
+
+  // Directories skipped by scan_for_components. Entries containing '/' are paths relative to the scan root
+  // (a leading '/' anchors a single name to it), other entries match a directory name at any depth.
+  std::vector<std::string> scan_ignore = { ".git", "/output", ".yakka/repos", component_cache_directory };
+
 private:
+  void index_yakka_file(const path &path, ryml::csubstr id, ryml::ConstNodeRef root);
+  std::expected<void, std::error_code> index_slcc_file(const path &path, ryml::ConstNodeRef root);
+
   path workspace_path;
   path database_filename;
   bool database_is_dirty{ false }; // Initialize member in-class
@@ -0,0 +1,333 @@
+/**
+ * @file dependency_log.cpp
+ * @brief Implements depfile parsing and the persisted binary dependency log.
+ */
+
+#include "dependency_log.hpp"
+#include "utilities.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace yakka {
+
+// Binary log layout: a signature and version followed by a sequence of records.
+// Each record starts with a 32-bit header holding the payload size, with the top bit set for
+// dependency records. Path records hold the path padded to a multiple of four bytes and are
+// assigned IDs in order of appearance. Dependency records hold the depfile path ID, the depfile
+// timestamp and the IDs of every prerequisite.
+static constexpr char dependency_log_signature[] = "# yakkadeps\n";
+static constexpr uint32_t dependency_log_version = 1;
+static constexpr uint32_t dependency_record_flag = 0x80000000;
+
+/// @brief Executes load.
+
+std::expected<void, std::error_code> dependency_log::load(const std::filesystem::path &filename)
+{
+  mapped_file file;
+  auto result = file.open(filename);
+  if (!result)
+    return std::unexpected(result.error());
+
+  auto contents                = file.contents();
+  const size_t signature_size  = sizeof(dependency_log_signature) - 1;
+  const size_t header_size     = signature_size + sizeof(uint32_t);
+  uint32_t version             = 0;
+  if (contents.size() < header_size || contents.substr(0, signature_size) != dependency_log_signature)
+    return std::unexpected(std::make_error_code(std::errc::illegal_byte_sequence));
+  std::memcpy(&version, contents.data() + signature_size, sizeof(version));
+  if (version != dependency_log_version) {
+    spdlog::info("Ignoring dependency log with version {}", version);
+    return std::unexpected(std::make_error_code(std::errc::illegal_byte_sequence));
+  }
+  contents.remove_prefix(header_size);
+
+  // IDs in the file are mapped through intern() so a log that already holds entries keeps its own
+  // IDs. Records already in memory are at least as recent as the file, so they are kept.
+  const bool was_empty = paths.empty() && records.empty();
+  std::vector<path_id> loaded_ids;
+
+  // A truncated or corrupt tail (e.g. an interrupted save) ends loading at the last complete record
+  while (contents.size() >= sizeof(uint32_t)) {
+    uint32_t header;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    const size_t payload_size = header & ~dependency_record_flag;
+    if (payload_size % sizeof(uint32_t) != 0 || contents.size() - sizeof(uint32_t) < payload_size)
+      break;
+    const char *payload = contents.data() + sizeof(uint32_t);
+
+    if (header & dependency_record_flag) {
+      if (payload_size < sizeof(path_id) + sizeof(int64_t))
+        break;
+      path_id depfile_id;
+      record r;
+      std::memcpy(&depfile_id, payload, sizeof(depfile_id));
+      std::memcpy(&r.depfile_time, payload + sizeof(path_id), sizeof(r.depfile_time));
+      const size_t count = (payload_size - sizeof(path_id) - sizeof(int64_t)) / sizeof(path_id);
+      r.dependencies.resize(count);
+      if (count > 0)
+        std::memcpy(r.dependencies.data(), payload + sizeof(path_id) + sizeof(int64_t), count * sizeof(path_id));
+
+      const bool valid = depfile_id < loaded_ids.size() && std::all_of(r.dependencies.begin(), r.dependencies.end(), [&](path_id id) {
+                           return id < loaded_ids.size();
+                         });
+      if (!valid)
+        break;
+      for (auto &id: r.dependencies)
+        id = loaded_ids[id];
+      records.try_emplace(loaded_ids[depfile_id], std::move(r));
+    } else {
+      std::string_view path(payload, payload_size);
+      path = path.substr(0, path.find('\0'));
+      loaded_ids.push_back(intern(path));
+    }
+
+    contents.remove_prefix(sizeof(uint32_t) + payload_size);
+  }
+
+  dirty = !was_empty;
+  return {};
+}
+
+/// @brief Executes save.
+
+std::expected<void, std::error_code> dependency_log::save(const std::filesystem::path &filename)
+{
+  // Records of depfiles that no longer exist are dropped
+  for (auto it = records.begin(); it != records.end();) {
+    std::error_code ec;
+    if (!std::filesystem::exists(paths[it->first], ec) && !ec)
+      it = records.erase(it);
+    else
+      ++it;
+  }
+
+  // Only the paths still used by a record are written, renumbered in their original order
+  constexpr path_id unused = ~path_id{ 0 };
+  std::vector<path_id> saved_ids(paths.size(), unused);
+  for (const auto &[depfile_id, r]: records) {
+    saved_ids[depfile_id] = 0;
+    for (const auto id: r.dependencies)
+      saved_ids[id] = 0;
+  }
+
+  std::string output;
+  output.append(dependency_log_signature, sizeof(dependency_log_signature) - 1);
+  output.append(reinterpret_cast<const char *>(&dependency_log_version), sizeof(dependency_log_version));
+
+  path_id next_id = 0;
+  for (path_id id = 0; id < paths.size(); ++id) {
+    if (saved_ids[id] == unused)
+      continue;
+    saved_ids[id]              = next_id++;
+    const auto &p              = paths[id];
+    const uint32_t padded_size = static_cast<uint32_t>((p.size() + sizeof(uint32_t)) & ~(sizeof(uint32_t) - 1));
+    output.append(reinterpret_cast<const char *>(&padded_size), sizeof(padded_size));
+    output.append(p);
+    output.append(padded_size - p.size(), '\0');
+  }
+
+  for (const auto &[depfile_id, r]: records) {
+    const uint32_t header = static_cast<uint32_t>(sizeof(path_id) + sizeof(int64_t) + r.dependencies.size() * sizeof(path_id)) | dependency_record_flag;
+    output.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.append(reinterpret_cast<const char *>(&saved_ids[depfile_id]), sizeof(path_id));
+    output.append(reinterpret_cast<const char *>(&r.depfile_time), sizeof(r.depfile_time));
+    for (const auto id: r.dependencies)
+      output.append(reinterpret_cast<const char *>(&saved_ids[id]), sizeof(path_id));
+  }
+
+  auto result = save_file_if_changed(filename, output);
+  if (!result)
+    return std::unexpected(result.error());
+
+  dirty = false;
+  return {};
+}
+
+/// @brief Executes intern.
+
+dependency_log::path_id dependency_log::intern(std::string_view path)
+{
+  auto it = path_ids.find(path);
+  if (it != path_ids.end())
+    return it->second;
+
+  const auto id = static_cast<path_id>(paths.size());
+  paths.emplace_back(path);
+  path_ids.insert({ paths.back(), id });
+  dirty = true;
+  return id;
+}
+
+/// @brief Executes path.
+
+ryml::csubstr dependency_log::path(path_id id) const
+{
+  const auto &p = paths[id];
+  return { p.data(), p.size() };
+}
+
+/// @brief Executes find_path.
+
+std::optional<dependency_log::path_id> dependency_log::find_path(std::string_view path) const
+{
+  auto it = path_ids.find(path);
+
+  if (it == path_ids.end())
+    return std::nullopt;
+  return it->second;
+}
+
+/// @brief Executes find.
+
+const dependency_log::record *dependency_log::find(std::string_view depfile) const
+{
+  const auto id = find_path(depfile);
+
+  if (!id)
+    return nullptr;
+  auto it = records.find(id.value());
+  return it == records.end() ? nullptr : &it->second;
+}
+
+/// @brief Executes update.
+
+std::expected<const dependency_log::record *, std::error_code> dependency_log::update(const std::string &depfile)
+{
+  std::error_code ec;
+  const auto depfile_time = std::filesystem::last_write_time(depfile, ec);
+  if (ec)
+    return std::unexpected(ec);
+
+  const auto depfile_id = intern(depfile);
+  auto it               = records.find(depfile_id);
+  const auto timestamp  = static_cast<int64_t>(depfile_time.time_since_epoch().count());
+  if (it != records.end() && it->second.depfile_time == timestamp)
+    return &it->second;
+
+  record r{ timestamp, {} };
+  std::unordered_set<path_id> seen;
+  auto result = parse_depfile(depfile, [&](std::string_view dependency) {
+    if (dependency.starts_with("./"))
+      dependency.remove_prefix(2);
+    const auto id = intern(dependency);
+    if (seen.insert(id).second)
+      r.dependencies.push_back(id);
+  });
+  if (!result)
+    return std::unexpected(result.error());
+
+  dirty = true;
+  return &(records[depfile_id] = std::move(r));
+}
+
+/// @brief Executes get_dependencies.
+
+std::vector<ryml::csubstr> dependency_log::get_dependencies(const std::string &depfile)
+{
+  std::vector<ryml::csubstr> dependencies;
+
+  auto r = update(depfile);
+  if (!r)
+    return dependencies;
+
+  dependencies.reserve(r.value()->dependencies.size());
+  for (const auto id: r.value()->dependencies)
+    dependencies.push_back(path(id));
+
+  return dependencies;
+}
+
+/// @brief Executes parse_depfile.
+
+std::expected<void, std::error_code> dependency_log::parse_depfile(const std::filesystem::path &filename, const std::function<void(std::string_view)> &function)
+{
+  mapped_file file;
+  auto result = file.open(filename);
+  if (!result)
+    return std::unexpected(result.error());
+
+  parse_depfile_contents(file.contents(), function);
+  return {};
+}
+
+/// @brief Executes parse_depfile_contents.
+
+// Handles the make syntax emitted by GCC, Clang and MSVC wrappers: escaped spaces and hashes,
+// `$$`, backslash-newline continuations and multiple rules such as the phony targets from -MP.
+// Tokens before the colon of a rule, written as `a.o:` or `a.o :`, are targets. A line without a
+// colon is taken as a list of prerequisites.
+void dependency_log::parse_depfile_contents(std::string_view contents, const std::function<void(std::string_view)> &function)
+{
+  std::string token;
+  std::vector<std::string> pending; // Tokens of the current rule that may still turn out to be targets
+  bool in_prerequisites = false;
+  size_t i = 0;
+
+  const auto end_rule = [&]() {
+    for (const auto &p: pending)
+      function(p);
+    pending.clear();
+    in_prerequisites = false;
+  };
+
+  while (i < contents.size()) {
+    // Skip separators and line continuations, a newline ends the rule
+    const char c = contents[i];
+    if (c == ' ' || c == '\t' || c == '\r') {
+      ++i;
+      continue;
+    }
+    if (c == '\n') {
+      end_rule();
+      ++i;
+      continue;
+    }
+    if (c == '\\' && i + 1 < contents.size() && (contents[i + 1] == '\n' || contents[i + 1] == '\r')) {
+      i += (contents[i + 1] == '\r' && i + 2 < contents.size() && contents[i + 2] == '\n') ? 3 : 2;
+      continue;
+    }
+
+    // Read one token, unescaping as we go
+    token.clear();
+    while (i < contents.size()) {
+      const char t = contents[i];
+      if (t == ' ' || t == '\t' || t == '\r' || t == '\n')
+        break;
+      if (t == '\\' && i + 1 < contents.size()) {
+        const char next = contents[i + 1];
+        if (next == '\n' || next == '\r')
+          break;
+        if (next == ' ' || next == '#') {
+          token.push_back(next);
+          i += 2;
+          continue;
+        }
+      } else if (t == '$' && i + 1 < contents.size() && contents[i + 1] == '$') {
+        token.push_back('$');
+        i += 2;
+        continue;
+      }
+      token.push_back(t);
+      ++i;
+    }
+
+    // A token ending in a colon, or a colon on its own, ends the targets of the rule
+    if (token.empty())
+      continue;
+    if (token.back() == ':') {
+      pending.clear();
+      in_prerequisites = true;
+      continue;
+    }
+
+    if (in_prerequisites)
+      function(token);
+    else
+      pending.push_back(token);
+  }
+  end_rule();
+}
+
+} // namespace yakka
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace yakka {
+
+/**
+ * @brief Persistent store of header dependencies discovered from compiler depfiles.
+ *
+ * Every path is interned once into a shared path table and each depfile is recorded as a list of
+ * path IDs together with the depfile timestamp. The log is saved in a compact binary format
+ * similar to `.ninja_deps` so repeated headers cost a single entry.
+ */
+class dependency_log {
+public:
+  typedef uint32_t path_id;
+
+  struct record {
+    int64_t depfile_time;
+    std::vector<path_id> dependencies;
+  };
+
+  // Merges a saved log into this one, records already held in memory are kept
+  std::expected<void, std::error_code> load(const std::filesystem::path &filename);
+  // Saves the log, dropping the records of depfiles that no longer exist
+  std::expected<void, std::error_code> save(const std::filesystem::path &filename);
+
+  // Returns the dependencies of a depfile, parsing it only if the log has no up to date record
+  std::vector<ryml::csubstr> get_dependencies(const std::string &depfile);
+  std::expected<const record *, std::error_code> update(const std::string &depfile);
+
+  path_id intern(std::string_view path);
+  ryml::csubstr path(path_id id) const;
+
+  // Returns the ID of a path already in the log
+  std::optional<path_id> find_path(std::string_view path) const;
+  // Returns the recorded dependencies of a depfile without checking that they are up to date
+  const record *find(std::string_view depfile) const;
+
+  // Parses the prerequisites of a make-style depfile, calling `function` for each unescaped path
+  static std::expected<void, std::error_code> parse_depfile(const std::filesystem::path &filename, const std::function<void(std::string_view)> &function);
+  static void parse_depfile_contents(std::string_view contents, const std::function<void(std::string_view)> &function);
+
+  bool is_dirty() const
+  {
+    return dirty;
+  }
+
+private:
+  std::deque<std::string> paths; // Stable storage so csubstrs handed out remain valid
+  std::unordered_map<std::string_view, path_id> path_ids;
+  std::unordered_map<path_id, record> records;
+  bool dirty = false;
+};
+
+} // namespace yakka
@@ -0,0 +1,244 @@
+/**
+ * @file ryml_merge.cpp
+ * @brief Implements bulk copy and merge of ryml subtrees.
+ */
+
+#include "ryml_merge.hpp"
+#include "spdlog/spdlog.h"
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace yakka {
+
+namespace {
+
+// Maps with at least this many entries are indexed before merging into them
+constexpr size_t indexed_map_size = 16;
+
+/// @brief Executes view.
+
+std::string_view view(ryml::csubstr s)
+{
+  return { s.str, s.len };
+}
+
+/// @brief Executes own_scalars.
+
+// Moves every scalar of the subtrees at `first`..`last` (siblings, inclusive) that lives in the arena of `source` into one block of the `target` arena
+void own_scalars(ryml::Tree *target, const ryml::Tree *source, size_t first, size_t last)
+{
+  if (target == source || first == ryml::NONE)
+
+    return;
+
+  // Keys, values, tags and anchors of a node
+  const auto fields = [](ryml::NodeData *n) {
+    return std::array<ryml::csubstr *, 6>{ &n->m_key.scalar, &n->m_key.tag, &n->m_key.anchor, &n->m_val.scalar, &n->m_val.tag, &n->m_val.anchor };
+  };
+
+  std::vector<std::pair<size_t, size_t>> fixups; // node, field
+  std::unordered_map<std::string_view, size_t> offsets;
+  size_t total = 0;
+
+  std::vector<size_t> pending;
+  for (size_t id = first;; id = target->next_sibling(id)) {
+    pending.push_back(id);
+    if (id == last)
+      break;
+  }
+  while (!pending.empty()) {
+    const size_t id = pending.back();
+    pending.pop_back();
+
+    const auto node_fields = fields(target->_p(id));
+    for (size_t f = 0; f < node_fields.size(); ++f) {
+      const auto s = *node_fields[f];
+      if (s.len == 0 || !source->in_arena(s))
+        continue;
+      fixups.push_back({ id, f });
+      if (offsets.insert({ view(s), total }).second)
+        total += s.len;
+    }
+    for (size_t child = target->first_child(id); child != ryml::NONE; child = target->next_sibling(child))
+      pending.push_back(child);
+  }
+
+  if (fixups.empty())
+    return;
+
+  // A single allocation keeps the block in place while it is filled
+  const ryml::substr block = target->alloc_arena(total);
+  for (const auto &[s, offset]: offsets)
+    std::memcpy(block.str + offset, s.data(), s.size());
+
+  for (const auto &[id, f]: fixups) {
+    auto *field = fields(target->_p(id))[f];
+    *field      = block.sub(offsets[view(*field)], field->len);
+  }
+}
+
+/// @brief Executes append_children.
+
+void append_children(ryml::Tree *target, size_t parent, const ryml::Tree *source, size_t node)
+{
+  const size_t after = target->last_child(parent);
+
+  const size_t last = target->duplicate_children(source, node, parent, after);
+  if (last == after)
+    return;
+  own_scalars(target, source, after == ryml::NONE ? target->first_child(parent) : target->next_sibling(after), last);
+}
+
+/// @brief Executes find_keyed_entry.
+
+// Entry of the sequence `seq` that is a map with `key` set to `value`
+size_t find_keyed_entry(const ryml::Tree *tree, size_t seq, ryml::csubstr key, ryml::csubstr value)
+{
+  for (size_t child = tree->first_child(seq); child != ryml::NONE; child = tree->next_sibling(child)) {
+
+    if (!tree->is_map(child))
+      continue;
+    const size_t entry_key = tree->find_child(child, key);
+    if (entry_key != ryml::NONE && tree->has_val(entry_key) && tree->val(entry_key) == value)
+      return child;
+  }
+  return ryml::NONE;
+}
+
+} // namespace
+
+/// @brief Executes ryml_copy.
+
+void ryml_copy(ryml::NodeRef dst, ryml::ConstNodeRef src)
+{
+  auto *target = dst.tree();
+
+  const auto *source = src.tree();
+  const size_t id    = dst.id();
+
+  target->remove_children(id);
+  if (src.is_map())
+    target->change_type(id, ryml::MAP);
+  else if (src.is_seq())
+    target->change_type(id, ryml::SEQ);
+  else {
+    target->change_type(id, ryml::VAL);
+    target->_p(id)->m_val = source->_p(src.id())->m_val;
+    own_scalars(target, source, id, id);
+    return;
+  }
+  append_children(target, id, source, src.id());
+}
+
+/// @brief Executes ryml_append_copy.
+
+ryml::NodeRef ryml_append_copy(ryml::NodeRef parent, ryml::ConstNodeRef src)
+{
+  auto *target = parent.tree();
+
+  const size_t copy = target->duplicate(src.tree(), src.id(), parent.id(), target->last_child(parent.id()));
+  own_scalars(target, src.tree(), copy, copy);
+  return { target, copy };
+}
+
+/// @brief Executes ryml_append_children.
+
+void ryml_append_children(ryml::NodeRef dst, ryml::ConstNodeRef src)
+{
+  append_children(dst.tree(), dst.id(), src.tree(), src.id());
+}
+
+/// @brief Executes ryml_merge.
+
+void ryml_merge(ryml::NodeRef dst, ryml::ConstNodeRef src, const ryml_merge_policy &policy)
+{
+  auto *target = dst.tree();
+
+  const auto *source = src.tree();
+
+  if (src.is_map()) {
+    if (!dst.has_val() && !dst.is_seq())
+      dst |= ryml::MAP;
+    if (!dst.is_map()) {
+      spdlog::error("Merging map into non-map node. Source: '{}', Destination: '{}'", view(src.key()), view(dst.key()));
+      return;
+    }
+
+    // Nothing to merge with, so the children are copied as one range
+    if (target->first_child(dst.id()) == ryml::NONE) {
+      append_children(target, dst.id(), source, src.id());
+      return;
+    }
+
+    // Large maps are looked up by key hash rather than scanned per key. Node IDs stay valid as the tree grows, unlike key views.
+    std::unordered_multimap<size_t, size_t> index;
+    size_t existing_count = 0;
+    for (size_t child = target->first_child(dst.id()); child != ryml::NONE && existing_count < indexed_map_size; child = target->next_sibling(child))
+      ++existing_count;
+    const bool indexed = existing_count == indexed_map_size;
+    if (indexed)
+      for (size_t child = target->first_child(dst.id()); child != ryml::NONE; child = target->next_sibling(child))
+        index.insert({ std::hash<std::string_view>{}(view(target->key(child))), child });
+
+    for (size_t child = source->first_child(src.id()); child != ryml::NONE; child = source->next_sibling(child)) {
+      const auto key    = source->key(child);
+      const size_t hash = indexed ? std::hash<std::string_view>{}(view(key)) : 0;
+      size_t existing   = ryml::NONE;
+      if (indexed) {
+        const auto [begin, end] = index.equal_range(hash);
+        for (auto it = begin; it != end && existing == ryml::NONE; ++it)
+          if (target->key(it->second) == key)
+            existing = it->second;
+      } else {
+        existing = target->find_child(dst.id(), key);
+      }
+
+      if (existing != ryml::NONE) {
+        ryml_merge({ target, existing }, { source, child }, policy);
+      } else {
+        const auto copy = ryml_append_copy(dst, { source, child });
+        if (indexed)
+          index.insert({ hash, copy.id() });
+      }
+    }
+  } else if (src.is_seq()) {
+    if (!dst.has_val() && !dst.is_map())
+      dst |= ryml::SEQ;
+    if (!dst.is_seq()) {
+      spdlog::error("Merging sequence into non-sequence node. Source: '{}', Destination: '{}'", view(src.key()), view(dst.key()));
+      return;
+    }
+
+    if (policy.sequence_key.empty()) {
+      append_children(target, dst.id(), source, src.id());
+      return;
+    }
+    for (size_t child = source->first_child(src.id()); child != ryml::NONE; child = source->next_sibling(child)) {
+      size_t existing = ryml::NONE;
+      if (source->is_map(child)) {
+        const size_t entry_key = source->find_child(child, policy.sequence_key);
+        if (entry_key != ryml::NONE && source->has_val(entry_key))
+          existing = find_keyed_entry(target, dst.id(), policy.sequence_key, source->val(entry_key));
+      }
+      if (existing == ryml::NONE)
+        ryml_append_copy(dst, { source, child });
+      else
+        ryml_merge({ target, existing }, { source, child }, policy);
+    }
+  } else if (src.has_val()) {
+    const auto value = target != source && source->in_arena(src.val()) ? target->copy_to_arena(src.val()) : src.val();
+    if (dst.is_seq())
+      dst.append_child().set_val(value);
+    else if (dst.is_map())
+      spdlog::error("Merging scalar into map. Source: '{}', Destination: '{}'", view(src.key()), view(dst.key()));
+    else
+      dst.set_val(value);
+  } else {
+    spdlog::error("Merging node with unknown type. Source: '{}', Destination: '{}'", view(src.key()), view(dst.key()));
+  }
+}
+
+} // namespace yakka
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+
+namespace yakka {
+
+/**
+ * @brief Copy and merge primitives for ryml trees.
+ *
+ * Subtrees are copied with ryml's bulk node duplication. Scalars held in the arena of the source
+ * tree are then copied into a single block of the destination arena, once per distinct string.
+ * Every other scalar stays a view (e.g. into a file buffer), so its storage must outlive `dst`.
+ */
+struct ryml_merge_policy {
+  // When set, sequence entries that are maps holding this key are merged into the existing entry with
+  // the same value instead of being appended
+  ryml::csubstr sequence_key = {};
+};
+
+// Replaces the contents of `dst` with a copy of `src`, keeping the key of `dst`
+void ryml_copy(ryml::NodeRef dst, ryml::ConstNodeRef src);
+
+// Appends a copy of `src`, including its key, as the last child of `parent`
+ryml::NodeRef ryml_append_copy(ryml::NodeRef parent, ryml::ConstNodeRef src);
+
+// Appends copies of the children of `src` after the last child of `dst`
+void ryml_append_children(ryml::NodeRef dst, ryml::ConstNodeRef src);
+
+// Merges `src` into `dst`: maps merge by key, sequences are appended (or merged by `policy.sequence_key`)
+// and scalars overwrite. Mismatched node kinds are reported and left unchanged.
+void ryml_merge(ryml::NodeRef dst, ryml::ConstNodeRef src, const ryml_merge_policy &policy = {});
+
+} // namespace yakka
@@ -0,0 +1,179 @@
+/**
+ * @file ryml_snapshot.cpp
+ * @brief Implements saving and loading ryml subtrees as binary snapshots.
+ */
+
+#include "ryml_snapshot.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace yakka {
+
+// Snapshot layout: a signature, version, node count and blob size, then one fixed size record per
+// node in pre-order and finally the blob of scalars. Scalars are referenced by offset and size
+// within the blob, with `no_scalar` marking a null scalar. Identical scalars are stored once.
+static constexpr char snapshot_signature[] = "# yakkasnapshot\n";
+static constexpr uint32_t snapshot_version = 1;
+static constexpr uint32_t no_scalar        = std::numeric_limits<uint32_t>::max();
+
+// Anchors, references and tags are not carried over
+static constexpr ryml::type_bits snapshot_type_mask = ~ryml::type_bits(ryml::KEYREF | ryml::VALREF | ryml::KEYANCH | ryml::VALANCH | ryml::KEYTAG | ryml::VALTAG);
+
+struct snapshot_header {
+  char signature[sizeof(snapshot_signature) - 1];
+  uint32_t version;
+  uint32_t node_count;
+  uint64_t blob_size;
+};
+
+struct snapshot_node {
+  uint64_t type;
+  uint32_t num_children;
+  uint32_t key_offset;
+  uint32_t key_size;
+  uint32_t val_offset;
+  uint32_t val_size;
+  uint32_t reserved;
+};
+
+/// @brief Executes ryml_snapshot.
+
+std::string ryml_snapshot(ryml::ConstNodeRef node)
+{
+  std::vector<snapshot_node> nodes;
+  std::string blob;
+  std::unordered_map<std::string_view, uint32_t> scalar_offsets;
+  std::vector<ryml::ConstNodeRef> pending{ node };
+
+  const auto add_scalar = [&](ryml::csubstr scalar, uint32_t &offset, uint32_t &size) {
+    if (scalar.str == nullptr) {
+      offset = no_scalar;
+      size   = 0;
+      return;
+    }
+    const std::string_view text{ scalar.str, scalar.len };
+    auto it = scalar_offsets.find(text);
+    if (it == scalar_offsets.end()) {
+      it = scalar_offsets.emplace(text, static_cast<uint32_t>(blob.size())).first;
+      blob.append(text);
+    }
+    offset = it->second;
+    size   = static_cast<uint32_t>(text.size());
+  };
+
+  // Depth first, pushing children in reverse so they are emitted in order
+  while (!pending.empty()) {
+    const auto n = pending.back();
+    pending.pop_back();
+
+    snapshot_node record{};
+    record.type         = static_cast<uint64_t>(n.type().type) & snapshot_type_mask;
+    record.num_children = static_cast<uint32_t>(n.num_children());
+    add_scalar(n.has_key() ? n.key() : ryml::csubstr{}, record.key_offset, record.key_size);
+    add_scalar(n.has_val() ? n.val() : ryml::csubstr{}, record.val_offset, record.val_size);
+    nodes.push_back(record);
+
+    for (auto child = n.last_child(); child.valid(); child = child.prev_sibling())
+      pending.push_back(child);
+  }
+
+  snapshot_header header{};
+  std::memcpy(header.signature, snapshot_signature, sizeof(header.signature));
+  header.version    = snapshot_version;
+  header.node_count = static_cast<uint32_t>(nodes.size());
+  header.blob_size  = blob.size();
+
+  std::string output;
+  output.reserve(sizeof(header) + nodes.size() * sizeof(snapshot_node) + blob.size());
+  output.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  output.append(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(snapshot_node));
+  output.append(blob);
+  return output;
+}
+
+/// @brief Executes ryml_load_snapshot.
+
+std::expected<ryml::NodeRef, std::error_code> ryml_load_snapshot(std::string_view snapshot, ryml::NodeRef parent)
+{
+  const auto invalid = std::make_error_code(std::errc::illegal_byte_sequence);
+
+  snapshot_header header;
+  if (snapshot.size() < sizeof(header))
+    return std::unexpected(invalid);
+  std::memcpy(&header, snapshot.data(), sizeof(header));
+  if (std::memcmp(header.signature, snapshot_signature, sizeof(header.signature)) != 0 || header.version != snapshot_version || header.node_count == 0)
+    return std::unexpected(invalid);
+
+  const size_t nodes_size = static_cast<size_t>(header.node_count) * sizeof(snapshot_node);
+  if (snapshot.size() - sizeof(header) < nodes_size || snapshot.size() - sizeof(header) - nodes_size != header.blob_size)
+    return std::unexpected(invalid);
+
+  const char *records = snapshot.data() + sizeof(header);
+  const char *blob    = records + nodes_size;
+
+  const auto get_scalar = [&](uint32_t offset, uint32_t size, ryml::csubstr &scalar) {
+    if (offset == no_scalar) {
+      scalar = {};
+      return true;
+    }
+    if (offset > header.blob_size || size > header.blob_size - offset)
+      return false;
+    scalar = ryml::csubstr{ blob + offset, size };
+    return true;
+  };
+
+  auto *tree = parent.tree();
+  tree->reserve(tree->size() + header.node_count);
+
+  // Each entry is a node still waiting for children and how many it expects
+  std::vector<std::pair<size_t, uint32_t>> open_nodes{ { parent.id(), 1 } };
+  size_t top = ryml::NONE;
+  uint32_t placed = 0;
+  for (; placed < header.node_count; ++placed) {
+    while (!open_nodes.empty() && open_nodes.back().second == 0)
+      open_nodes.pop_back();
+    if (open_nodes.empty())
+      break;
+
+    snapshot_node record;
+    std::memcpy(&record, records + placed * sizeof(snapshot_node), sizeof(record));
+
+    // Keys are required exactly for children of maps, and containers cannot have values
+    ryml::csubstr key, val;
+    const size_t parent_id  = open_nodes.back().first;
+    const bool valid_record = get_scalar(record.key_offset, record.key_size, key) && get_scalar(record.val_offset, record.val_size, val)
+                              && !((record.type & (ryml::MAP | ryml::SEQ)) && (record.type & ryml::VAL))
+                              && (tree->is_map(parent_id) == ((record.type & ryml::KEY) != 0));
+    if (!valid_record)
+      break;
+
+    --open_nodes.back().second;
+    const size_t id = tree->append_child(parent_id);
+    if (top == ryml::NONE)
+      top = id;
+
+    auto *data         = tree->get(id);
+    data->m_type       = static_cast<ryml::NodeType_e>(record.type);
+    data->m_key.scalar = key;
+    data->m_val.scalar = val;
+    if (record.num_children > 0)
+      open_nodes.push_back({ id, record.num_children });
+  }
+
+  // Every record must have been placed with no node left waiting for children
+  const bool complete = placed == header.node_count && std::all_of(open_nodes.begin(), open_nodes.end(), [](const auto &n) {
+                          return n.second == 0;
+                        });
+  if (!complete) {
+    if (top != ryml::NONE)
+      tree->remove(top);
+    return std::unexpected(invalid);
+  }
+  return ryml::NodeRef{ tree, top };
+}
+
+} // namespace yakka
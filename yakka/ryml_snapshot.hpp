@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace yakka {
+
+/**
+ * @brief Binary snapshots of ryml subtrees.
+ *
+ * A snapshot holds the nodes of a subtree in pre-order followed by a blob with every key and value,
+ * so it can be loaded back without parsing. Loaded scalars are views into the snapshot data, which
+ * must therefore outlive the nodes created from it.
+ */
+std::string ryml_snapshot(ryml::ConstNodeRef node);
+
+// Appends the snapshotted subtree as the last child of `parent`, returning the new node
+std::expected<ryml::NodeRef, std::error_code> ryml_load_snapshot(std::string_view snapshot, ryml::NodeRef parent);
+
+} // namespace yakka
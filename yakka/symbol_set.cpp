@@ -0,0 +1,155 @@
+/**
+ * @file symbol_set.cpp
+ * @brief Implements the interned symbol table and the bitset backed symbol sets.
+ */
+#include "symbol_set.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace yakka {
+
+/// @brief Executes symbol_table::intern.
+
+symbol_table::symbol_id symbol_table::intern(ryml::csubstr name)
+{
+  const std::string_view key{ name.str, name.len };
+
+  auto it = ids.find(key);
+  if (it != ids.end())
+    return it->second;
+
+  const auto id = static_cast<symbol_id>(names.size());
+  storage.emplace_back(key);
+  names.push_back(ryml::to_csubstr(storage.back()));
+  ids.insert({ storage.back(), id });
+  return id;
+}
+
+/// @brief Executes symbol_table::find.
+
+std::optional<symbol_table::symbol_id> symbol_table::find(ryml::csubstr name) const
+{
+  auto it = ids.find(std::string_view{ name.str, name.len });
+
+  if (it == ids.end())
+    return std::nullopt;
+  return it->second;
+}
+
+/// @brief Executes symbol_set::insert.
+
+std::pair<symbol_set::const_iterator, bool> symbol_set::insert(ryml::csubstr name)
+{
+  return insert(symbols->intern(name));
+}
+
+/// @brief Executes symbol_set::insert.
+
+std::pair<symbol_set::const_iterator, bool> symbol_set::insert(symbol_id id)
+{
+  if (id / 64 >= words.size())
+
+    words.resize(id / 64 + 1, 0);
+
+  const uint64_t bit = uint64_t{ 1 } << (id % 64);
+  const bool added   = (words[id / 64] & bit) == 0;
+  if (added) {
+    words[id / 64] |= bit;
+    ++count;
+  }
+  return { const_iterator(this, id), added };
+}
+
+/// @brief Executes symbol_set::contains.
+
+bool symbol_set::contains(ryml::csubstr name) const
+{
+  const auto id = symbols->find(name);
+
+  return id.has_value() && contains(id.value());
+}
+
+/// @brief Executes symbol_set::erase.
+
+size_t symbol_set::erase(ryml::csubstr name)
+{
+  const auto id = symbols->find(name);
+
+  if (!id || !contains(id.value()))
+    return 0;
+
+  words[id.value() / 64] &= ~(uint64_t{ 1 } << (id.value() % 64));
+  --count;
+  return 1;
+}
+
+/// @brief Executes symbol_set::erase.
+
+symbol_set::const_iterator symbol_set::erase(const_iterator position)
+{
+  const auto id = position.id();
+
+  words[id / 64] &= ~(uint64_t{ 1 } << (id % 64));
+  --count;
+  return const_iterator(this, id + 1);
+}
+
+/// @brief Executes symbol_set::operator|=.
+
+symbol_set &symbol_set::operator|=(const symbol_set &other)
+{
+  if (other.words.size() > words.size())
+
+    words.resize(other.words.size(), 0);
+
+  count = 0;
+  for (size_t i = 0; i < words.size(); ++i) {
+    if (i < other.words.size())
+      words[i] |= other.words[i];
+    count += std::popcount(words[i]);
+  }
+  return *this;
+}
+
+/// @brief Executes symbol_set::operator-=.
+
+symbol_set &symbol_set::operator-=(const symbol_set &other)
+{
+  const auto common = std::min(words.size(), other.words.size());
+
+  for (size_t i = 0; i < common; ++i) {
+    count -= std::popcount(words[i] & other.words[i]);
+    words[i] &= ~other.words[i];
+  }
+  return *this;
+}
+
+/// @brief Executes symbol_set::includes.
+
+bool symbol_set::includes(const symbol_set &other) const
+{
+  for (size_t i = 0; i < other.words.size(); ++i) {
+
+    const uint64_t mine = i < words.size() ? words[i] : 0;
+    if ((other.words[i] & ~mine) != 0)
+      return false;
+  }
+  return true;
+}
+
+/// @brief Executes symbol_set::next.
+
+size_t symbol_set::next(size_t position) const
+{
+  const size_t end = words.size() * 64;
+
+  while (position < end) {
+    const uint64_t remaining = words[position / 64] >> (position % 64);
+    if (remaining != 0)
+      return position + std::countr_zero(remaining);
+    position = (position / 64 + 1) * 64;
+  }
+  return end;
+}
+
+} // namespace yakka
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace yakka {
+
+/**
+ * @brief Interns component and feature IDs into dense integers.
+ *
+ * Names are copied into stable storage, so the csubstrs handed out remain valid for the life of
+ * the table even if the tree they came from is cleared. The table is not thread safe.
+ */
+class symbol_table {
+public:
+  typedef uint32_t symbol_id;
+
+  symbol_id intern(ryml::csubstr name);
+  std::optional<symbol_id> find(ryml::csubstr name) const;
+
+  ryml::csubstr name(symbol_id id) const
+  {
+    return names[id];
+  }
+
+  size_t size() const
+  {
+    return names.size();
+  }
+
+private:
+  std::deque<std::string> storage;
+  std::vector<ryml::csubstr> names;
+  std::unordered_map<std::string_view, symbol_id> ids;
+};
+
+/**
+ * @brief Set of interned IDs stored as a dynamic bitset.
+ *
+ * Offers the subset of the `std::unordered_set<ryml::csubstr>` interface used by the project, and
+ * iterates in interning order. Unions, differences and subset checks work a word at a time.
+ */
+class symbol_set {
+public:
+  typedef symbol_table::symbol_id symbol_id;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = ryml::csubstr;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = ryml::csubstr;
+
+    const_iterator() = default;
+    const_iterator(const symbol_set *set, size_t position) : set(set), position(set->next(position))
+    {
+    }
+
+    ryml::csubstr operator*() const
+    {
+      return set->symbols->name(static_cast<symbol_id>(position));
+    }
+    const_iterator &operator++()
+    {
+      position = set->next(position + 1);
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      auto previous = *this;
+      ++*this;
+      return previous;
+    }
+    // Positions past the last word all compare equal to end(), so the set may grow while iterating
+    bool operator==(const const_iterator &other) const
+    {
+      return std::min(position, set->words.size() * 64) == std::min(other.position, other.set->words.size() * 64);
+    }
+    symbol_id id() const
+    {
+      return static_cast<symbol_id>(position);
+    }
+
+  private:
+    const symbol_set *set = nullptr;
+    size_t position       = 0;
+  };
+  typedef const_iterator iterator;
+
+  explicit symbol_set(symbol_table &symbols) : symbols(&symbols)
+  {
+  }
+  symbol_set(const symbol_set &)            = default;
+  symbol_set &operator=(const symbol_set &) = default;
+  symbol_set(symbol_set &&other) noexcept : symbols(other.symbols), words(std::move(other.words)), count(std::exchange(other.count, 0))
+  {
+    other.words.clear();
+  }
+  symbol_set &operator=(symbol_set &&other) noexcept
+  {
+    symbols = other.symbols;
+    words   = std::move(other.words);
+    count   = std::exchange(other.count, 0);
+    other.words.clear();
+    return *this;
+  }
+
+  std::pair<const_iterator, bool> insert(ryml::csubstr name);
+  std::pair<const_iterator, bool> insert(symbol_id id);
+  bool contains(ryml::csubstr name) const;
+  bool contains(symbol_id id) const
+  {
+    return id / 64 < words.size() && (words[id / 64] >> (id % 64) & 1) != 0;
+  }
+  size_t erase(ryml::csubstr name);
+  const_iterator erase(const_iterator position);
+
+  // Adds every member of `other`
+  symbol_set &operator|=(const symbol_set &other);
+  // Removes every member of `other`
+  symbol_set &operator-=(const symbol_set &other);
+  // True if every member of `other` is also a member of this set
+  bool includes(const symbol_set &other) const;
+
+  void clear()
+  {
+    words.clear();
+    count = 0;
+  }
+  void swap(symbol_set &other) noexcept
+  {
+    std::swap(symbols, other.symbols);
+    words.swap(other.words);
+    std::swap(count, other.count);
+  }
+  size_t size() const
+  {
+    return count;
+  }
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const
+  {
+    return const_iterator(this, words.size() * 64);
+  }
+  const_iterator cbegin() const
+  {
+    return begin();
+  }
+  const_iterator cend() const
+  {
+    return end();
+  }
+
+private:
+  // Position of the first member at or after `position`, or the end position if there is none
+  size_t next(size_t position) const;
+
+  symbol_table *symbols;
+  std::vector<uint64_t> words;
+  size_t count = 0;
+};
+
+} // namespace yakka
@@ -7,6 +7,8 @@
 #include "blueprint_database.hpp"
 #include "inja.hpp"
 #include "yakka.hpp"
+#include "ryml_snapshot.hpp"
+#include "utilities.hpp"
 
 #include <regex>
 
@@ -25,4 +27,39 @@ const std::vector<std::shared_ptr<blueprint_match>>& target_database::add_target
   return targets[target];
 }
 
+/// @brief Executes save.
+
+std::expected<void, std::error_code> target_database::save(const std::filesystem::path &file_path) const
+{
+  ryml::Tree graph;
+
+  graph.rootref() |= ryml::MAP;
+  for (const auto &[target, matches]: targets) {
+    // Targets without a match are files
+    if (matches.empty())
+      continue;
+
+    auto node = graph.rootref().append_child();
+    node.set_key(target);
+    node |= ryml::MAP;
+    auto dependencies = node.append_child();
+    dependencies.set_key("dependencies");
+    dependencies |= ryml::SEQ;
+    auto depfiles = node.append_child();
+    depfiles.set_key("depfiles");
+    depfiles |= ryml::SEQ;
+    for (const auto &m: matches) {
+      for (const auto &d: m->dependencies)
+        dependencies.append_child().set_val(d);
+      if (!m->depfile.empty())
+        depfiles.append_child().set_val(ryml::to_csubstr(m->depfile));
+    }
+  }
+
+  auto result = save_file_if_changed(file_path, ryml_snapshot(graph.rootref()));
+  if (!result)
+    return std::unexpected(result.error());
+  return {};
+}
+
 } // namespace yakka
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "blueprint_database.hpp"
+#include <expected>
 #include <string>
 #include <vector>
 #include <memory>
@@ -11,8 +12,8 @@ namespace fs = std::filesystem;
 namespace yakka {
 class target_database {
 public:
-  void load(const std::filesystem::path file_path);
-  void save(const std::filesystem::path file_path);
+  // Saves the dependencies and depfiles of every matched target as a snapshot, which is read without the blueprints
+  std::expected<void, std::error_code> save(const std::filesystem::path &file_path) const;
 
   const std::vector<std::shared_ptr<blueprint_match>>& add_target(ryml::csubstr target, blueprint_database &blueprint_database, ryml::ConstNodeRef project_summary);
   const std::vector<std::shared_ptr<blueprint_match>>& get_target(ryml::csubstr target) const {
@@ -15,6 +15,29 @@ using namespace std::chrono_literals;
 
 namespace yakka {
 
+/// @brief Executes file_stat_cache::last_write_time.
+
+std::optional<fs::file_time_type> file_stat_cache::last_write_time(const std::string &path)
+{
+  {
+
+    std::shared_lock lock(mutex);
+    auto it = times.find(path);
+    if (it != times.end())
+      return it->second;
+  }
+
+  // A single stat answers both whether the file exists and when it was modified
+  std::error_code ec;
+  const auto time = fs::last_write_time(path, ec);
+  std::optional<fs::file_time_type> result;
+  if (!ec)
+    result = time;
+
+  std::unique_lock lock(mutex);
+  return times.try_emplace(path, result).first->second;
+}
+
 /// @brief Executes is_valid.
 
 bool task_engine::is_valid()
@@ -107,7 +130,8 @@ void task_engine::create_tasks(ryml::csubstr target_name, tf::Task &parent, yakk
       construct_task->task.work([&, construct_task, target_name_string]() {
         // spdlog::info("{}: data", target_name);
         // auto d     = static_cast<std::shared_ptr<construction_task>>(task.data());
-        auto result = has_data_dependency_changed(target_name_string, project.previous_summary, project.project_summary);
+        const auto *hashes = summary_hashes_current ? &project.summary_hashes : nullptr;
+        auto result        = has_data_dependency_changed(target_name_string, project.previous_summary, project.project_summary, hashes);
         if (result) {
           construct_task->last_modified = *result ? fs::file_time_type::max() : fs::file_time_type::min();
         } else {
@@ -120,15 +144,15 @@ void task_engine::create_tasks(ryml::csubstr target_name, tf::Task &parent, yakk
       });
     }
     // Check if target name matches an existing file in filesystem
-    else if (fs::exists(target_name_string)) {
-      // Create a new task to retrieve the file timestamp
+    else if (const auto last_modified = stat_cache->last_write_time(target_name_string)) {
+      // Create a new task to apply the file timestamp
 /// @brief Executes work.
 
-      construct_task->task.work([construct_task, target_name_string]() {
+      construct_task->task.work([construct_task, last_modified]() {
         // uint8_t hash[32];
         // hash_file(target_name, hash);
 
-        construct_task->last_modified = fs::last_write_time(target_name_string);
+        construct_task->last_modified = last_modified.value();
         //spdlog::info("{}: timestamp {}", target_name, (uint)d->last_modified.time_since_epoch().count());
         return;
       });
@@ -190,6 +214,7 @@ void task_engine::create_tasks(ryml::csubstr target_name, tf::Task &parent, yakk
                 abort_build = true;
                 return;
               }
+              ingest_depfile(construct_task->match, project);
             } catch (const std::exception &e) {
               spdlog::error("Error running command for {}: {}", target_name_string, e.what());
               abort_build = true;
@@ -222,6 +247,7 @@ void task_engine::create_tasks(ryml::csubstr target_name, tf::Task &parent, yakk
                 abort_build = true;
                 return;
               }
+              ingest_depfile(construct_task->match, project);
             } catch (const std::exception &e) {
               spdlog::error("Error running command for {}: {}", target_name_string, e.what());
               abort_build = true;
@@ -329,9 +355,9 @@ std::pair<std::string, int> task_engine::run_command(const std::string target, s
           aggregate[i.key()] = i.has_val() ? i.val() : nullptr;
       else if (v.is_seq())
         for (const auto i: v.children())
-          aggregate.append_child() << inja_env.render(i.val<std::string>().value(), project.project_summary);
+          aggregate.append_child() << render_cached(inja_env, i.val<std::string>().value(), project.project_summary);
       else
-        aggregate.append_child() << inja_env.render(v.val<std::string>().value(), project.project_summary);
+        aggregate.append_child() << render_cached(inja_env, v.val<std::string>().value(), project.project_summary);
     }
     return aggregate;
   });
@@ -417,6 +443,9 @@ std::pair<std::string, int> task_engine::run_command(const std::string target, s
         }
         // Else check if it is a built-in command
         else if (blueprint_commands.contains(ryml_string(command_name))) {
+          // Saving into the project data leaves the precomputed hashes stale
+          if (command_name == "save")
+            summary_hashes_current = false;
           yakka::process_return test_result = blueprint_commands.at(ryml_string(command_name))(target, command, captured_output, project.project_summary, project_data, inja_env);
           captured_output                   = test_result.result;
           retcode                           = test_result.retcode;
@@ -439,11 +468,29 @@ std::pair<std::string, int> task_engine::run_command(const std::string target, s
   return { captured_output, 0 };
 }
 
+/// @brief Executes ingest_depfile.
+
+// Records the dependencies the process just emitted so the next incremental build sees them
+// without re-scanning the depfile while generating the target database.
+void task_engine::ingest_depfile(const std::shared_ptr<blueprint_match> &match, yakka::project &project)
+{
+  if (match->depfile.empty() || !fs::exists(match->depfile))
+    return;
+
+  std::lock_guard<std::mutex> lock(dependency_log_mutex);
+  auto result = project.blueprint_database.dependency_log.update(match->depfile);
+  if (!result)
+    spdlog::error("Failed to read dependency file {}: {}", match->depfile, result.error().message());
+}
+
 /// @brief Executes run_taskflow.
 
 void task_engine::run_taskflow(yakka::project &project, task_engine_ui *ui)
 {
-  tf::Executor executor(std::min(32U, std::thread::hardware_concurrency()));
+  auto &executor = project.get_executor();
+
+  project.hash_summaries(executor);
+  summary_hashes_current = true;
 
   todo_task_groups["Processing"] = std::make_shared<yakka::task_group>("Processing");
 /// @brief Executes emplace.
@@ -490,6 +537,20 @@ void task_engine::run_taskflow(yakka::project &project, task_engine_ui *ui)
   } while (execution_future.wait_for(500ms) != std::future_status::ready);
 
   ui->finish(*this);
+
+  if (!fs::exists(project.output_path))
+    return;
+  if (project.blueprint_database.dependency_log.is_dirty())
+    project.blueprint_database.dependency_log.save(project.output_path / dependency_log_filename);
+
+  // Affected queries treat the saved graph as built, so a failed build leaves none and its targets stay outstanding
+  const auto graph_path = project.output_path / target_graph_filename;
+  if (abort_build) {
+    std::error_code ec;
+    fs::remove(graph_path, ec);
+  } else if (auto saved = project.target_database.save(graph_path); !saved) {
+    spdlog::info("Failed to save target graph: {}", saved.error().message());
+  }
 }
 
 } // namespace yakka
@@ -12,6 +12,10 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace yakka {
 
@@ -44,6 +48,18 @@ struct construction_task {
   }
 };
 
+// Modification times of source files, which do not change during a build. Task engines building
+// several variants of the same sources share one cache so each file is only stat'ed once.
+class file_stat_cache {
+public:
+  // Last write time of `path`, or nullopt if it does not exist
+  std::optional<fs::file_time_type> last_write_time(const std::string &path);
+
+private:
+  std::shared_mutex mutex;
+  std::unordered_map<std::string, std::optional<fs::file_time_type>> times;
+};
+
 struct task_engine_ui {
   virtual void init(task_engine &task_engine)   = 0;
   virtual void update(task_engine &task_engine) = 0;
@@ -61,14 +77,18 @@ public:
   void create_tasks(ryml::csubstr target_name, tf::Task &parent, yakka::project &project);
   std::pair<std::string, int> run_command(const std::string target, std::shared_ptr<blueprint_match> blueprint, const project &project, ryml::NodeRef project_data);
   void run_taskflow(yakka::project &project, task_engine_ui *ui);
+  void ingest_depfile(const std::shared_ptr<blueprint_match> &match, yakka::project &project);
   bool is_valid();
 
   std::atomic<bool> abort_build;
+  std::atomic<bool> summary_hashes_current{ false }; // Cleared once a command may have modified the project data
   ryml::Tree project_data;
   tf::Taskflow taskflow;
 
   task_complete_type task_complete_handler;
   std::multimap<ryml::csubstr, std::shared_ptr<construction_task>> todo_list;
   std::map<ryml::csubstr, std::shared_ptr<task_group>> todo_task_groups;
+  std::mutex dependency_log_mutex;
+  std::shared_ptr<file_stat_cache> stat_cache = std::make_shared<file_stat_cache>();
 };
 } // namespace yakka
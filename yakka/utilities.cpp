@@ -30,6 +30,20 @@
 #include <cctype>
 #include <filesystem>
 #include <sstream>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <array>
+#include <unordered_map>
+#include <thread>
+#if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace yakka {
 
@@ -258,107 +272,6 @@ std::string generate_project_name(const component_list_t &components, const feat
   return project_name;
 }
 
-/**
- * @brief Merges a node into a merge_target node according to the rules defined in the provided schema, if any.
- *       If no schema is provided, the node is merged according to the default rules: scalars are overwritten, sequences are concatenated, and maps are merged with new keys added and existing keys overwritten.
- * @param path  Path relative to Yakka component schema
-
-/// @brief Executes copy_node_recursive.
-
- * @param merge_target  Node to merge into. This node is modified in place.
- * @param node  Node to merge. This node is not modified.
- * @param schema  Optional schema to define merge behavior. If not provided, default merge behavior is used.
- */
-static void copy_node_recursive(ryml::ConstNodeRef source, ryml::NodeRef destination)
-{
-  if (source.is_map()) {
-    destination |= ryml::MAP;
-    destination.tree()->duplicate_children(source.tree(), source.id(), destination.id(), c4::yml::NONE);
-    return;
-  }
-
-  if (source.is_seq()) {
-    destination |= ryml::SEQ;
-    destination.tree()->duplicate_children(source.tree(), source.id(), destination.id(), c4::yml::NONE);
-    return;
-  }
-
-  if (source.has_val()) {
-    destination.set_val(source.val());
-  }
-}
-
-/// @brief Executes append_duplicate_children.
-
-static void append_duplicate_children(ryml::ConstNodeRef source, ryml::NodeRef destination_parent)
-{
-  const auto after = destination_parent.num_children() > 0 ? destination_parent.last_child().id() : c4::yml::NONE;
-
-  destination_parent.tree()->duplicate_children(source.tree(), source.id(), destination_parent.id(), after);
-}
-
-/// @brief Executes append_duplicate_node.
-
-static void append_duplicate_node(ryml::ConstNodeRef source, ryml::NodeRef destination_parent)
-{
-  const auto after = destination_parent.num_children() > 0 ? destination_parent.last_child().id() : c4::yml::NONE;
-
-  destination_parent.tree()->duplicate(source.tree(), source.id(), destination_parent.id(), after);
-}
-
-/// @brief Executes merge_nodes.
-
-void merge_nodes(ryml::NodeRef dst, ryml::ConstNodeRef src)
-{
-  // If src is a map
-
-  if (src.is_map()) {
-    // dst.to_map(); // ensure type
-    if (!dst.has_val() && !dst.is_seq())
-      dst |= ryml::MAP;
-    
-    if (!dst.is_map()) {
-      spdlog::error("Merging map into non-map node. Source: '{}', Destination: '{}'", src.key(), dst.key());
-      return;
-    }
-
-    for (auto const &ch: src.children()) {
-      auto key       = ch.key();
-      auto dst_child = dst.has_child(key) ? dst.at(key) : dst.append_child();
-      dst_child << ryml::key(key);
-
-      merge_nodes(dst_child, ch);
-    }
-  }
-  // If src is a sequence
-  else if (src.is_seq()) {
-    // dst.to_seq(); // ensure type
-    if (!dst.has_val() && !dst.is_map())
-      dst |= ryml::SEQ;
-    if (!dst.is_seq()) {
-      spdlog::error("Merging sequence into non-sequence node. Source: '{}', Destination: '{}'", src.key(), dst.key());
-      return;
-    }
-
-    for (auto const &ch: src.children()) {
-      auto dst_child = dst.append_child();
-      merge_nodes(dst_child, ch);
-    }
-  }
-  // Scalar
-  else if (src.has_val()) {
-    if (dst.is_seq()) {
-      dst.append_child() << src.val();
-    } else if (dst.is_map()) {
-      spdlog::error("Merging scalar into map. Source: '{}', Destination: '{}'", src.key(), dst.key());
-    } else {
-      dst.set_val(src.val());
-    }
-  } else {
-    spdlog::error("Merging node with unknown type. Source: '{}', Destination: '{}'", src.key(), dst.key());
-  }
-}
-
 /// @brief Executes merge_node_default.
 
 static void merge_node_default(ryml::NodeRef target, ryml::ConstNodeRef source)
@@ -366,7 +279,7 @@ static void merge_node_default(ryml::NodeRef target, ryml::ConstNodeRef source)
   if (source.is_map()) {
 
     if (!target.is_map()) {
-      copy_node_recursive(source, target);
+      ryml_copy(target, source);
       return;
     }
 
@@ -377,7 +290,7 @@ static void merge_node_default(ryml::NodeRef target, ryml::ConstNodeRef source)
 
       const auto key = child.key();
       if (!target.has_child(key)) {
-        append_duplicate_node(child, target);
+        ryml_append_copy(target, child);
         continue;
       }
 
@@ -385,29 +298,30 @@ static void merge_node_default(ryml::NodeRef target, ryml::ConstNodeRef source)
       if (child.is_map() && target_child.is_map()) {
         merge_node_default(target_child, child);
       } else if (child.is_seq() && target_child.is_seq()) {
-        append_duplicate_children(child, target_child);
+        ryml_append_children(target_child, child);
       } else {
-        copy_node_recursive(child, target_child);
+        ryml_copy(target_child, child);
       }
     }
     return;
   }
 
-  if (source.is_seq()) {
-    if (!target.is_seq()) {
-      copy_node_recursive(source, target);
-      return;
-    }
-
-    append_duplicate_children(source, target);
+  if (source.is_seq() && target.is_seq()) {
+    ryml_append_children(target, source);
     return;
   }
 
-  copy_node_recursive(source, target);
+  ryml_copy(target, source);
 }
 
-/// @brief Executes json_node_merge.
-
+/**
+ * @brief Merges a node into a merge_target node according to the rules defined in the provided schema, if any.
+ *       If no schema is provided, the node is merged according to the default rules: scalars are overwritten, sequences are concatenated, and maps are merged with new keys added and existing keys overwritten.
+ * @param path  Path relative to Yakka component schema
+ * @param merge_target  Node to merge into. This node is modified in place.
+ * @param node  Node to merge. This node is not modified.
+ * @param schema  Optional schema to define merge behavior. If not provided, default merge behavior is used.
+ */
 void json_node_merge(ryml::Pointer path, ryml::NodeRef merge_target, ryml::ConstNodeRef node, const schema *schema)
 {
   (void)schema;
@@ -469,13 +383,131 @@ std::string try_render(inja::Environment &env, const std::string &input, ryml::C
   return try_render(env, std::string_view(input), data);
 
 }
+// Parsed templates keyed by the parsing environment's syntax settings and the source text.
+// Callbacks are resolved by the renderer at render time so a template parsed by one environment
+// can be rendered by any other environment with the same syntax.
+namespace {
+constexpr size_t template_cache_limit = 4096;
+
+// Syntax settings that change how a template is parsed. Lookups view an environment's settings,
+// cache entries view their own copies.
+struct template_key {
+  std::array<std::string_view, 7> tokens;
+  std::array<bool, 3> flags;
+  std::string_view text;
+
+  bool operator==(const template_key &) const = default;
+};
+
+template_key make_template_key(const inja::Environment &env, std::string_view text)
+{
+  const auto &lexer  = env.get_lexer_config();
+  const auto &parser = env.get_parser_config();
+  return { { lexer.statement_open, lexer.statement_close, lexer.line_statement, lexer.expression_open, lexer.expression_close, lexer.comment_open, lexer.comment_close },
+           { lexer.trim_blocks, lexer.lstrip_blocks, parser.search_included_templates_in_files },
+           text };
+}
+
+struct template_key_hash {
+  size_t operator()(const template_key &key) const noexcept
+  {
+    XXH64_hash_t hash = XXH64(key.text.data(), key.text.size(), 0);
+    for (const auto token: key.tokens)
+      hash = XXH64(token.data(), token.size(), hash);
+    return static_cast<size_t>(XXH64(key.flags.data(), key.flags.size(), hash));
+  }
+};
+
+struct template_cache_entry {
+  std::array<std::string, 7> tokens;
+  std::string text;
+  template_key key;
+  std::shared_ptr<const inja::Template> parsed;
+};
+
+// Returns true if the template has an include or extends statement. Those are resolved into the
+// parsing environment's own storage, so the parsed template cannot be shared.
+bool has_template_reference(const inja::LexerConfig &lexer, std::string_view input)
+{
+  const auto references_template = [](std::string_view statement) {
+    const auto start = statement.find_first_not_of(" \t+-");
+    if (start == std::string_view::npos)
+      return false;
+    statement.remove_prefix(start);
+    return statement.starts_with("include") || statement.starts_with("extends");
+  };
+
+  for (const auto &open: { std::string_view{ lexer.statement_open }, std::string_view{ lexer.line_statement } }) {
+    if (open.empty())
+      continue;
+    for (auto pos = input.find(open); pos != std::string_view::npos; pos = input.find(open, pos + open.size()))
+      if (references_template(input.substr(pos + open.size())))
+        return true;
+  }
+  return false;
+}
+
+// Entries are kept in least recently used order, the map keys view the strings owned by each entry
+std::mutex template_cache_mutex;
+std::list<template_cache_entry> template_cache_order;
+std::unordered_map<template_key, std::list<template_cache_entry>::iterator, template_key_hash> template_cache;
+} // namespace
+
+/// @brief Executes get_cached_template.
+
+std::shared_ptr<const inja::Template> get_cached_template(inja::Environment &env, std::string_view input)
+{
+  if (has_template_reference(env.get_lexer_config(), input))
+    return std::make_shared<const inja::Template>(env.parse(input));
+
+  const auto key = make_template_key(env, input);
+  {
+    std::lock_guard lock(template_cache_mutex);
+    if (auto it = template_cache.find(key); it != template_cache.end()) {
+      template_cache_order.splice(template_cache_order.begin(), template_cache_order, it->second);
+      return it->second->parsed;
+    }
+  }
+
+  auto parsed = std::make_shared<const inja::Template>(env.parse(input));
+  std::lock_guard lock(template_cache_mutex);
+  if (auto it = template_cache.find(key); it != template_cache.end())
+    return it->second->parsed;
+
+  // Evict the least recently used template rather than grow without bound
+  if (template_cache.size() >= template_cache_limit) {
+    template_cache.erase(template_cache_order.back().key);
+    template_cache_order.pop_back();
+  }
+
+  auto &entry = template_cache_order.emplace_front();
+  std::ranges::copy(key.tokens, entry.tokens.begin());
+  entry.text = input;
+  entry.key  = { {}, key.flags, entry.text };
+  std::ranges::copy(entry.tokens, entry.key.tokens.begin());
+  entry.parsed = std::move(parsed);
+  template_cache.emplace(entry.key, template_cache_order.begin());
+  return entry.parsed;
+}
+
+/// @brief Executes render_cached.
+
+std::string render_cached(inja::Environment &env, std::string_view input, ryml::ConstNodeRef data)
+{
+  // Plain text has nothing to render. open_chars holds the first character of every configured opener.
+  if (input.find_first_of(env.get_lexer_config().open_chars) == std::string_view::npos)
+    return std::string(input);
+
+  return env.render(*get_cached_template(env, input), data);
+}
+
 /// @brief Executes try_render.
 
 std::string try_render(inja::Environment &env, std::string_view input, ryml::ConstNodeRef data)
 {
   try {
 
-    return env.render(input, data);
+    return render_cached(env, input, data);
   } catch (std::exception &e) {
     spdlog::error("Template error: {}\n{}", input, e.what());
     return "";
@@ -798,6 +830,53 @@ ryml::Pointer create_condition_pointer(const ryml::Tree condition)
 }
 #endif
 
+/// @brief Executes hash_node.
+
+// Structural (Merkle) hash of a node: its kind and value combined with the keys and hashes of its
+// children. Results are memoised by node ID so a subtree is only hashed once per run.
+uint64_t hash_node(ryml::ConstNodeRef node, node_hashes &hashes)
+{
+  auto &cached = hashes[node.id()];
+  if (cached != 0)
+    return cached;
+
+  XXH64_state_t state;
+  XXH64_reset(&state, 0);
+  const uint8_t kind = node.is_map() ? 1 : node.is_seq() ? 2 : 3;
+  XXH64_update(&state, &kind, sizeof(kind));
+  if (node.has_val()) {
+    const auto value = node.val();
+    const auto size  = static_cast<uint64_t>(value.len);
+    XXH64_update(&state, &size, sizeof(size));
+    XXH64_update(&state, value.str, value.len);
+  }
+
+  for (const auto child: node.children()) {
+    if (child.has_key()) {
+      const auto key  = child.key();
+      const auto size = static_cast<uint64_t>(key.len);
+      XXH64_update(&state, &size, sizeof(size));
+      XXH64_update(&state, key.str, key.len);
+    }
+    const auto child_hash = hash_node(child, hashes);
+    XXH64_update(&state, &child_hash, sizeof(child_hash));
+  }
+
+  // Zero marks a node that has not been hashed yet
+  const auto result = XXH64_digest(&state);
+  cached            = result != 0 ? result : 1;
+  return cached;
+}
+
+/// @brief Executes find_node_hash.
+
+// Read-only lookup of a precomputed hash. Returns zero for nodes outside the hashed range or not
+// yet hashed, so concurrent readers never write to the shared table.
+uint64_t find_node_hash(ryml::ConstNodeRef node, const node_hashes &hashes) noexcept
+{
+  return node.id() < hashes.size() ? hashes[node.id()] : 0;
+}
+
 // Helper struct to hold component comparison results
 struct ComparisonResult {
   bool changed{ false };
@@ -807,7 +886,7 @@ struct ComparisonResult {
 /// @brief Executes has_data_dependency_changed.
 
 [[nodiscard]]
-std::expected<bool, std::string> has_data_dependency_changed(std::string data_path, ryml::ConstNodeRef left, ryml::ConstNodeRef right) noexcept
+std::expected<bool, std::string> has_data_dependency_changed(std::string data_path, ryml::ConstNodeRef left, ryml::ConstNodeRef right, const node_hashes *hashes) noexcept
 {
 
   if (data_path.empty() || data_path[0] != data_dependency_identifier) {
@@ -843,6 +922,18 @@ std::expected<bool, std::string> has_data_dependency_changed(std::string data_pa
   const auto left_components  = left_root["components"];
   const auto right_components = right_root["components"];
 
+  // Compare subtree hashes when available, otherwise fall back to comparing the serialised values
+  const auto values_differ = [&](ryml::ConstNodeRef left_value, ryml::ConstNodeRef right_value) {
+    // Nodes that were not hashed up front are compared by value
+    if (hashes != nullptr) {
+      const auto left_hash  = find_node_hash(left_value, *hashes);
+      const auto right_hash = find_node_hash(right_value, *hashes);
+      if (left_hash != 0 && right_hash != 0)
+        return left_hash != right_hash;
+    }
+    return ryml::emitrs_json<std::string>(left_value) != ryml::emitrs_json<std::string>(right_value);
+  };
+
   // Define a lambda to process a component name using the captured 'left' and 'right' json objects
   const auto process_component = [&](ryml::csubstr component_name, const ryml::Pointer &pointer) -> ComparisonResult {
     if (!left_components.valid() || !right_components.valid() || !left_components.is_map() || !right_components.is_map()) {
@@ -867,9 +958,7 @@ std::expected<bool, std::string> has_data_dependency_changed(std::string data_pa
       return { true, "" };
     }
 
-    auto left_serialized  = ryml::emitrs_json<std::string>(left_value);
-    auto right_serialized = ryml::emitrs_json<std::string>(right_value);
-    return { left_serialized != right_serialized, "" };
+    return { values_differ(left_value, right_value), "" };
   };
 
   try {
@@ -885,12 +974,32 @@ std::expected<bool, std::string> has_data_dependency_changed(std::string data_pa
             continue;
           }
           ryml::csubstr component_name = child.key();
-          auto result                  = process_component(component_name, remaining_pointer);
+
+          // An added component only matters if it provides the data
+          if (left_components.valid() && left_components.is_map() && !left_components.has_child(component_name)) {
+            if (remaining_pointer.empty() || child.contains(remaining_pointer))
+              return true;
+            continue;
+          }
+
+          auto result = process_component(component_name, remaining_pointer);
           if (!result.error_message.empty()) {
             return std::unexpected{ std::move(result.error_message) };
           }
-          return result.changed;
+          if (result.changed)
+            return true;
+        }
+
+        // Likewise a removed component only matters if it provided the data
+        if (left_components.valid() && left_components.is_map()) {
+          for (const auto child: left_components.children()) {
+            if (!child.has_key() || right_components.has_child(child.key()))
+              continue;
+            if (remaining_pointer.empty() || child.contains(remaining_pointer))
+              return true;
+          }
         }
+        return false;
       } else {
         ryml::csubstr component_name = c4::to_csubstr(second_part);
         auto result                  = process_component(component_name, remaining_pointer);
@@ -905,9 +1014,7 @@ std::expected<bool, std::string> has_data_dependency_changed(std::string data_pa
       if (!left_value.valid() || !right_value.valid()) {
         return true;
       }
-      auto left_serialized  = ryml::emitrs_json<std::string>(left_value);
-      auto right_serialized = ryml::emitrs_json<std::string>(right_value);
-      return { left_serialized != right_serialized };
+      return values_differ(left_value, right_value);
     }
 
     return false;
@@ -973,6 +1080,27 @@ void hash_file(std::filesystem::path filename, uint8_t out_hash[32]) noexcept
  * A more efficient implementation would build the tree in place without merging and avoid unnecessary string copies.
  */
 
+/// @brief Executes file_digest.
+
+std::string file_digest(const std::filesystem::path &filename)
+{
+  uint8_t hash[BLAKE3_OUT_LEN];
+  hash_file(filename, hash);
+  return bytes_to_hex(hash, sizeof(hash));
+}
+
+/// @brief Executes content_digest.
+
+std::string content_digest(std::string_view content)
+{
+  uint8_t hash[BLAKE3_OUT_LEN];
+  blake3_hasher hasher;
+  blake3_hasher_init(&hasher);
+  blake3_hasher_update(&hasher, content.data(), content.size());
+  blake3_hasher_finalize(&hasher, hash, BLAKE3_OUT_LEN);
+  return bytes_to_hex(hash, sizeof(hash));
+}
+
 /// @brief Executes xml_to_json.
 
 void xml_to_json(const pugi::xml_node &node, ryml::NodeRef &target)
@@ -1173,55 +1301,6 @@ std::filesystem::path ryml_path(c4::csubstr path)
   return fs::path{ path_str };
 }
 
-// Merge two ryml nodes
-/// @brief Executes ryml_node_merge.
-
-void ryml_node_merge(ryml::ConstNodeRef source, ryml::NodeRef target, const schema *schema)
-{
-  // For now, implement basic merging
-
-  // Full implementation would need to handle merge strategies from schema
-  if (!source.valid() || !target.valid()) {
-    return;
-  }
-
-  if (source.is_map() && target.is_map()) {
-    for (const auto &child: source.children()) {
-      if (!child.has_key())
-        continue;
-
-      c4::csubstr key = child.key();
-      if (target.has_child(key)) {
-        ryml::NodeRef target_child = target.find_child(key);
-        if (child.is_map() && target_child.is_map()) {
-          ryml_node_merge(child, target_child, schema);
-        } else {
-          // Overwrite with new value - copy the node value
-          if (child.has_val()) {
-            target_child.set_val(child.val());
-          }
-        }
-      } else {
-        // Add new key - this is complex, simplified for now
-        // In a full implementation, would need to properly copy the entire subtree
-        if (child.has_val()) {
-          ryml::NodeRef new_child = target.append_child();
-          new_child << ryml::key(key);
-          new_child << child.val();
-        }
-      }
-    }
-  } else if (source.is_seq() && target.is_seq()) {
-    // For sequences, append all elements
-    for (const auto &child: source.children()) {
-      if (child.has_val()) {
-        ryml::NodeRef new_child = target.append_child();
-        new_child << child.val();
-      }
-    }
-  }
-}
-
 /**
  * Navigate to a specific path in a ryml tree, creating nodes if needed
  * @param node The root node to navigate from
@@ -1300,18 +1379,127 @@ void ryml_node_merge(ryml::ConstNodeRef source, ryml::NodeRef target, const sche
 //   return ryml_navigate_path(node, path.parts(), create_if_missing);
 // }
 
-/// @brief Executes ryml_save_file.
+/// @brief Executes mapped_file::open.
 
-void ryml_save_file(const std::filesystem::path &path, ryml::ConstNodeRef node)
+std::expected<void, std::error_code> mapped_file::open(const std::filesystem::path &filename)
 {
-  try {
+  close();
+#if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
+  auto result = get_file_contents(filename, &buffer);
+  if (!result)
+    return std::unexpected(result.error());
+  data = buffer.data();
+  size = buffer.size();
+#else
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return std::unexpected(std::error_code(errno, std::generic_category()));
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0) {
+    const auto error = std::error_code(errno, std::generic_category());
+    ::close(fd);
+    return std::unexpected(error);
+  }
+
+  // mmap() rejects empty mappings, an empty file is simply an empty view
+  if (file_stat.st_size > 0) {
+    void *mapping = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      const auto error = std::error_code(errno, std::generic_category());
+      ::close(fd);
+      return std::unexpected(error);
+    }
+    data = static_cast<const char *>(mapping);
+    size = static_cast<size_t>(file_stat.st_size);
+  }
+  ::close(fd);
+#endif
+  return {};
+}
+
+/// @brief Executes mapped_file::close.
+
+void mapped_file::close()
+{
+#if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
+  buffer.clear();
+#else
+  if (data != nullptr)
+    ::munmap(const_cast<char *>(data), size);
+#endif
+  data = nullptr;
+  size = 0;
+}
+
+mapped_file::~mapped_file()
+{
+  close();
+}
 
-    std::ofstream file(path);
+/// @brief Executes save_file_if_changed.
+
+// Unchanged files are left untouched so their timestamps don't trigger rebuilds. Changed content is
+// written to a temporary file that is renamed over the destination, so readers never see a partial file.
+std::expected<bool, std::error_code> save_file_if_changed(const std::filesystem::path &path, std::string_view content)
+{
+  {
+    mapped_file existing;
+    if (existing.open(path) && existing.contents() == content)
+      return false;
+  }
+
+  // Each writer has its own temporary file, so concurrent saves of the same path cannot interleave
+#if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
+  const auto process_id = _getpid();
+#else
+  const auto process_id = getpid();
+#endif
+  std::filesystem::path temp_path = path;
+  temp_path += std::format(".{}.{}.tmp", process_id, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-      spdlog::error("Failed to open file for writing: {}", path.generic_string());
-      return;
+      spdlog::error("Failed to open file for writing: {}", temp_path.generic_string());
+      return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!file.flush()) {
+      std::error_code ec;
+      std::filesystem::remove(temp_path, ec);
+      return std::unexpected(std::make_error_code(std::errc::io_error));
     }
-    file << ryml::emitrs_yaml<std::string>(node);
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    spdlog::error("Failed to replace {}: {}", path.generic_string(), ec.message());
+    std::filesystem::remove(temp_path, ec);
+    return std::unexpected(std::make_error_code(std::errc::io_error));
+  }
+  return true;
+}
+
+/// @brief Executes is_up_to_date.
+
+// True if `derived` exists and was written no earlier than `source`
+bool is_up_to_date(const std::filesystem::path &derived, const std::filesystem::path &source)
+{
+  std::error_code ec;
+  const auto derived_time = std::filesystem::last_write_time(derived, ec);
+  if (ec)
+    return false;
+  const auto source_time = std::filesystem::last_write_time(source, ec);
+  return ec || derived_time >= source_time;
+}
+
+/// @brief Executes ryml_save_file.
+
+void ryml_save_file(const std::filesystem::path &path, ryml::ConstNodeRef node)
+{
+  try {
+    save_file_if_changed(path, ryml::emitrs_yaml<std::string>(node));
   } catch (const std::exception &e) {
     spdlog::error("Error saving ryml tree to file {}: {}", path.generic_string(), e.what());
   }
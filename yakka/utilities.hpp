@@ -4,6 +4,7 @@
 #include "inja.hpp"
 #include "pugixml.hpp"
 #include "yakka_schema.hpp"
+#include "ryml_merge.hpp"
 // #include "rapidyaml_pointer.hpp"
 // #include "pointer.hpp"
 
@@ -15,6 +16,7 @@
 #include <unordered_set>
 #include <filesystem>
 #include <optional>
+#include <memory>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -37,10 +39,8 @@ struct fmt::formatter<c4::csubstr> : fmt::formatter<std::string_view>
 
 namespace yakka {
 
-void ryml_node_merge(ryml::ConstNodeRef source, ryml::NodeRef target, const schema* schema = nullptr);
 // void json_node_merge(const std::vector<std::string> &path, ryml::NodeRef merge_target, ryml::ConstNodeRef node, const schema* schema = nullptr);
 void json_node_merge(ryml::Pointer path, ryml::NodeRef merge_target, ryml::ConstNodeRef node, const schema* schema = nullptr);
-void merge_nodes(ryml::NodeRef dst, ryml::ConstNodeRef src);
 
 std::pair<std::string, int> exec(const std::string &command_text, const std::string &arg_text);
 int exec(const std::string &command_text, const std::string &arg_text, std::function<void(std::string &)> function);
@@ -50,6 +50,8 @@ YAML::Node yaml_path(const YAML::Node &node, std::string path);
 bool ryml_has_child(ryml::ConstNodeRef node, c4::csubstr key);
 std::expected<ryml::Tree, std::error_code> ryml_load_file(const std::filesystem::path &path);
 void ryml_save_file(const std::filesystem::path &path, ryml::ConstNodeRef node);
+std::expected<bool, std::error_code> save_file_if_changed(const std::filesystem::path &path, std::string_view content);
+bool is_up_to_date(const std::filesystem::path &derived, const std::filesystem::path &source);
 std::filesystem::path ryml_path(c4::csubstr path);
 static inline std::string ryml_string(c4::csubstr str)
 {
@@ -61,6 +63,8 @@ std::string generate_project_name(const component_list_t &components, const feat
 std::vector<ryml::csubstr> parse_gcc_dependency_file(const std::string &filename);
 ryml::csubstr component_dotname_to_id(const ryml::csubstr dotname);
 std::filesystem::path get_yakka_shared_home();
+std::shared_ptr<const inja::Template> get_cached_template(inja::Environment &env, std::string_view input);
+std::string render_cached(inja::Environment &env, std::string_view input, ryml::ConstNodeRef data);
 std::string try_render(inja::Environment &env, std::string_view input, ryml::ConstNodeRef data);
 std::string try_render(inja::Environment &env, ryml::csubstr input, ryml::ConstNodeRef data);
 std::string try_render(inja::Environment &env, const std::string &input, ryml::ConstNodeRef data);
@@ -72,13 +76,43 @@ ryml::Pointer create_condition_pointer(ryml::ConstNodeRef condition);
 void find_json_keys(ryml::ConstNodeRef j, const std::string &target_key, const std::string &current_path, ryml::NodeRef paths);
 
 void hash_file(std::filesystem::path filename, uint8_t out_hash[32]) noexcept;
+std::string file_digest(const std::filesystem::path &filename);
+std::string content_digest(std::string_view content);
 void xml_to_json(const pugi::xml_node& node, ryml::NodeRef& target);
 
-std::expected<bool, std::string> has_data_dependency_changed(std::string data_path, ryml::ConstNodeRef left, ryml::ConstNodeRef right) noexcept;
+// Structural hashes indexed by node ID; zero marks a node that has not been hashed yet
+typedef std::vector<uint64_t> node_hashes;
+uint64_t hash_node(ryml::ConstNodeRef node, node_hashes &hashes);
+uint64_t find_node_hash(ryml::ConstNodeRef node, const node_hashes &hashes) noexcept;
+std::expected<bool, std::string> has_data_dependency_changed(std::string data_path, ryml::ConstNodeRef left, ryml::ConstNodeRef right, const node_hashes *hashes = nullptr) noexcept;
 
 void add_common_template_commands(inja::Environment &inja_env);
 
 
+/// Read-only view of a whole file. Memory mapped where the platform supports it.
+class mapped_file {
+public:
+  mapped_file() = default;
+  ~mapped_file();
+  mapped_file(const mapped_file &)            = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  std::expected<void, std::error_code> open(const std::filesystem::path &filename);
+  void close();
+
+  std::string_view contents() const
+  {
+    return { data, size };
+  }
+
+private:
+  const char *data = nullptr;
+  size_t size      = 0;
+#if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
+  std::string buffer;
+#endif
+};
+
 template <class CharContainer>
 static std::expected<size_t, std::error_code> get_file_contents(std::filesystem::path filename, CharContainer *container)
 {
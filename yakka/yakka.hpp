@@ -24,7 +24,20 @@ const char data_wildcard_identifier             = '*';
 const std::string database_filename             = "yakka-components.json";
 const std::string projects_filename             = "yakka-projects.json";
 const std::string project_summary_filename      = "yakka_summary.yaml";
+const std::string project_snapshot_filename     = "yakka_summary.bin"; // Binary copy of the summary loaded in place of the YAML
+const std::string fingerprint_filename          = "yakka_fingerprint.txt"; // Digests of the evaluation inputs behind the summary
+const std::string dependency_log_filename       = "yakka.deps";
+const std::string target_graph_filename         = "yakka_targets.bin"; // Snapshot of the target dependency graph read by affected queries
+const std::string component_cache_directory     = "component_cache"; // Parsed component snapshots within the shared home
+const std::string component_cache_count_filename = "snapshot_count"; // Snapshots in a cache, so the cache is only listed to trim it
+const size_t component_cache_limit              = 20000; // Snapshots kept per cache, see component::prune_cache()
+const int component_cache_max_age_days          = 30;    // Age after which caches of other yakka versions are removed
+const std::string contributions_filename        = "template_contributions.json";
+const std::string contributions_directory       = "template_contributions"; // One file per template contribution name
+const std::string contribution_sources_filename = "template_contribution_sources.yaml"; // Contributions before and after sorting, restored with a reused evaluation
 const std::string default_output_directory      = "output/";
+const size_t project_arena_chunk_size           = 16 * 1024 * 1024; // Initial arena chunk for project data, see project::log_arena_usage()
+const size_t blueprint_arena_chunk_size         = 8 * 1024 * 1024;  // Initial arena chunk for the blueprint database
 
 #if defined(_WIN64) || defined(_WIN32) || defined(__CYGWIN__)
 const std::string host_os_string         = "windows";
@@ -21,6 +21,9 @@ blueprint::blueprint(c4::csubstr target, ryml::ConstNodeRef blueprint_data, c4::
   if (root.has_child("regex"))
     this->regex = root["regex"].val();
 
+  if (root.has_child("depfile"))
+    this->depfile = root["depfile"].val();
+
   if (root.has_child("requires") && root["requires"].is_seq()) {
     for (const auto d: root["requires"].children())
       this->requirements.push_back(d.val());
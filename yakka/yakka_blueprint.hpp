@@ -16,6 +16,7 @@ struct blueprint {
   };
   c4::csubstr target;
   std::optional<c4::csubstr> regex;
+  std::optional<c4::csubstr> depfile; // Dependency file emitted by the process, e.g. from -MD
   std::vector<c4::csubstr> requirements;
   std::vector<dependency> dependencies; // Unprocessed dependencies. Raw values as found in the YAML.
   ryml::ConstNodeRef data;
@@ -28,11 +28,21 @@
 #include <chrono>
 #include <future>
 #include <algorithm>
+#include <format>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 using namespace indicators;
 using namespace std::chrono_literals;
 
-static void evaluate_project_dependencies(yakka::workspace &workspace, yakka::project &project);
+static void configure_project(yakka::project &project, const cxxopts::ParseResult &result);
+static std::string evaluation_inputs(const std::vector<std::string> &build_string, const cxxopts::ParseResult &result);
+static int build_project(yakka::workspace &workspace, yakka::project &project, const cxxopts::ParseResult &result, const std::string &inputs, yakka::task_engine &task_engine, yakka::task_engine_ui *ui, bool shared_workspace);
+static int build_matrix(yakka::workspace &workspace, const cxxopts::ParseResult &result);
+static std::optional<int> evaluate_project(yakka::workspace &workspace, yakka::project &project, const cxxopts::ParseResult &result, bool shared_workspace);
+static std::optional<int> evaluate_project_dependencies(yakka::workspace &workspace, yakka::project &project, bool shared_workspace);
 static void print_project_choice_errors(yakka::project &project);
 
 struct progress_bar_task_ui : yakka::task_engine_ui {
@@ -96,6 +106,13 @@ struct progress_bar_task_ui : yakka::task_engine_ui {
   };
 };
 
+// Progress is not drawn for variants of a matrix build as they run side by side
+struct silent_task_ui : yakka::task_engine_ui {
+  void init(yakka::task_engine &) {};
+  void update(yakka::task_engine &) {};
+  void finish(yakka::task_engine &) {};
+};
+
 static const semver::version yakka_version{
 #include "yakka_version.h"
 };
@@ -151,7 +168,7 @@ int main(int argc, char **argv)
                        ("d,data", "Additional data", cxxopts::value<std::string>())
                        ("no-slcc", "Ignore SLC files", cxxopts::value<bool>()->default_value("false"))
                        ("no-yakka", "Ignore Yakka files", cxxopts::value<bool>()->default_value("false"))
-                       ("action", "Select from 'register', 'list', 'update', 'git', 'remove', 'fetch', 'serve' or a command", cxxopts::value<std::string>());
+                       ("action", "Select from 'register', 'list', 'update', 'git', 'remove', 'fetch', 'serve', 'matrix', 'affected' or a command", cxxopts::value<std::string>());
   // clang-format on
 
   options.parse_positional({ "action" });
@@ -193,6 +210,8 @@ int main(int argc, char **argv)
   }
 
   auto action = result["action"].as<std::string>();
+  if (action == "matrix")
+    return build_matrix(workspace, result);
   if (action.back() != '!') {
     // Check if the action exists in our map
     auto action_it = yakka::cli_actions.find(action);
@@ -247,7 +266,30 @@ int main(int argc, char **argv)
   
   project.add_command(action);
 
+  configure_project(project, result);
+
+  std::vector<std::string> build_string{ action };
+  std::ranges::copy(result.unmatched(), std::back_inserter(build_string));
+
+  yakka::task_engine task_engine;
+  progress_bar_task_ui progress_bar_ui;
+  const int status = build_project(workspace, project, result, evaluation_inputs(build_string, result), task_engine, &progress_bar_ui, false);
+
+  auto yakka_end_time = fs::file_time_type::clock::now();
+  std::cout << "Complete in " << std::chrono::duration_cast<std::chrono::milliseconds>(yakka_end_time - yakka_start_time).count() << " milliseconds" << std::endl;
+
+  spdlog::shutdown();
+  show_console_cursor(true);
+
+  return status;
+}
+
+/// @brief Executes configure_project.
+
+static void configure_project(yakka::project &project, const cxxopts::ParseResult &result)
+{
   // Check if we don't want Yakka files
+
   if (result["no-yakka"].count() != 0) {
     project.component_flags = yakka::component_database::flag::IGNORE_YAKKA;
   }
@@ -263,19 +305,221 @@ int main(int argc, char **argv)
         project.slc_required.insert(c4::to_csubstr(f));
     }
   }
+}
+
+/// @brief Executes evaluation_inputs.
+
+// Everything on the command line that affects the evaluation of a project
+static std::string evaluation_inputs(const std::vector<std::string> &build_string, const cxxopts::ParseResult &result)
+{
+  std::string evaluation_inputs = yakka_version.str();
+
+  for (const auto &s: build_string)
+    evaluation_inputs += "\n" + s;
+  evaluation_inputs += std::format("\nno-yakka={} no-slcc={} no-eval={}", result["no-yakka"].count(), result["no-slcc"].count(), result["no-eval"].as<bool>());
+  if (result["with"].count() != 0)
+    for (const auto &f: result["with"].as<std::vector<std::string>>())
+      evaluation_inputs += "\nwith " + f;
+  if (result["data"].count() != 0)
+    evaluation_inputs += "\ndata " + result["data"].as<std::string>();
+  return evaluation_inputs;
+}
+
+/// @brief Executes build_project.
+
+// Evaluates the project and runs its commands. A shared workspace is never rescanned or fetched into, as other projects are reading it.
+static int build_project(yakka::workspace &workspace, yakka::project &project, const cxxopts::ParseResult &result, const std::string &inputs, yakka::task_engine &task_engine, yakka::task_engine_ui *ui, bool shared_workspace)
+{
+  if (!result["no-eval"].as<bool>() && project.restore_evaluation(inputs)) {
+
+    spdlog::info("Project inputs are unchanged, reusing the previous evaluation");
+  } else {
+    if (auto status = evaluate_project(workspace, project, result, shared_workspace))
+      return status.value();
+    if (project.current_state == yakka::project::state::PROJECT_VALID && !result["no-eval"].as<bool>())
+      project.save_evaluation_fingerprint(inputs);
+  }
+
+  // Insert additional command line data before processing blueprints
+  if (result["data"].count() != 0) {
+    spdlog::info("Processing additional data: {}", result["data"].as<std::string>());
+    const auto additional_data = "{" + result["data"].as<std::string>() + "}";
+    // ryml::Tree data       = ryml::parse_in_arena(ryml::to_csubstr(additional_data));
+    auto node = project.project_summary["temp"].append_child();
+    node |= ryml::MAP;
+    ryml::parse_in_arena(ryml::to_csubstr(additional_data), node);
+    yakka::ryml_merge(project.project_summary["data"], node);
+  }
+
+  auto t1 = std::chrono::high_resolution_clock::now();
+  project.process_blueprints();
+
+  project.save_blueprints();
+
+  // Ensure all the commands have a blueprint
+  spdlog::info("Checking for missing blueprints");
+  for (const auto &c: project.commands) {
+    if (project.blueprint_database.blueprints.contains(c))
+      continue;
+
+    // Find a component that has that blueprint
+    auto result = workspace.find_blueprint(c);
+    if (result) {
+      const auto blueprint_options = result.value();
+      if (blueprint_options.num_children() == 1) {
+        auto component_name = blueprint_options[0].val();
+        auto component_paths       = workspace.find_component(component_name);
+        if (component_paths) {
+          auto [component_path, db_path] = component_paths.value();
+          spdlog::info("Found a blueprint for {}: {}", c, component_path.string());
+          project.add_additional_tool(component_path);
+        } else {
+          spdlog::error("Could not find component for blueprint: {}", c);
+        }
+      } else {
+        spdlog::error("Multiple options for missing blueprint {}", c);
+        for (const auto &o: blueprint_options)
+          spdlog::error("- {}", o.val<std::string>().value());
+        return -1;
+      }
+    } else {
+      spdlog::info("Did not find a blueprint for {}", c);
+    }
+  }
+
+  try {
+    spdlog::debug("Generating target database");
+    project.generate_target_database();
+  } catch (const std::exception &e) {
+    spdlog::error("Failed to generate target database: {}", e.what());
+    return -1;
+  }
+  auto t2       = std::chrono::high_resolution_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+  spdlog::info("{}ms to process blueprints", duration);
+
+  try {
+    task_engine.run_taskflow(project, ui);
+  } catch (const std::exception &e) {
+    spdlog::error("Running task engine failed: {}", e.what());
+    return -1;
+  }
+
+  project.log_arena_usage();
+
+  if (task_engine.abort_build)
+    return -1;
+  else
+    return 0;
+}
+
+/// @brief Executes build_matrix.
+
+// Builds every variant listed in a matrix file, one build string per line. Words following the file name on the
+// command line (e.g. commands) are added to every variant. The variants share the workspace, the parsed component
+// snapshots, the executor and the file stat cache, and each keeps its own output directory.
+static int build_matrix(yakka::workspace &workspace, const cxxopts::ParseResult &result)
+{
+  const auto &words = result.unmatched();
+
+  if (words.empty()) {
+    spdlog::error("Usage: yakka matrix <file> [commands!]");
+    return -1;
+  }
+  auto contents = yakka::get_file_contents<std::string>(words.front());
+  if (!contents) {
+    spdlog::error("Failed to read matrix file '{}'", words.front());
+    return -1;
+  }
+
+  yakka::component::share_snapshots = true;
+  tf::Executor executor;
+  auto stat_cache = std::make_shared<yakka::file_stat_cache>();
+
+  std::vector<std::unique_ptr<yakka::project>> projects;
+  std::vector<std::string> inputs;
+  std::unordered_set<std::string> project_names;
+  std::istringstream lines(contents.value());
+  for (std::string line; std::getline(lines, line);) {
+    std::istringstream line_stream(line);
+    std::vector<std::string> build_string;
+    for (std::string word; line_stream >> word;)
+      build_string.push_back(word);
+
+    // Skip blank lines and comments
+    if (build_string.empty() || build_string.front().front() == '#')
+      continue;
+    build_string.insert(build_string.end(), words.begin() + 1, words.end());
+
+    auto project = std::make_unique<yakka::project>(workspace);
+    project->init_project(build_string);
+    if (project->commands.empty()) {
+      spdlog::error("Matrix entry '{}' has no command", line);
+      return -1;
+    }
+    if (!project_names.insert(project->project_name).second) {
+      spdlog::error("Matrix entry '{}' duplicates project '{}'", line, project->project_name);
+      return -1;
+    }
+    configure_project(*project, result);
+    project->executor = &executor;
+    inputs.push_back(evaluation_inputs(build_string, result));
+    projects.push_back(std::move(project));
+  }
+
+  // Each variant is driven by its own thread, while the work of all variants runs on the shared executor
+  std::vector<int> status(projects.size(), 0);
+  std::atomic<size_t> next_project = 0;
+  {
+    std::vector<std::jthread> threads;
+    const size_t thread_count = std::min<size_t>(projects.size(), std::max(1u, std::thread::hardware_concurrency()));
+    for (size_t t = 0; t < thread_count; ++t)
+      threads.emplace_back([&]() {
+        for (size_t i = next_project++; i < projects.size(); i = next_project++) {
+          yakka::task_engine task_engine;
+          silent_task_ui ui;
+          task_engine.stat_cache = stat_cache;
+          try {
+            status[i] = build_project(workspace, *projects[i], result, inputs[i], task_engine, &ui, true);
+          } catch (const std::exception &e) {
+            spdlog::error("Building '{}' failed: {}", projects[i]->project_name, e.what());
+            status[i] = -1;
+          }
+        }
+      });
+  }
+
+  size_t failed = 0;
+  for (size_t i = 0; i < projects.size(); ++i) {
+    std::cout << (status[i] == 0 ? "PASS " : "FAIL ") << projects[i]->project_name << "\n";
+    if (status[i] != 0)
+      ++failed;
+  }
+  std::cout << projects.size() - failed << "/" << projects.size() << " variants built" << std::endl;
+
+  spdlog::shutdown();
+  return failed == 0 ? 0 : -1;
+}
 
+/// @brief Executes evaluate_project.
+
+// Returns the exit status when the evaluation failed
+static std::optional<int> evaluate_project(yakka::workspace &workspace, yakka::project &project, const cxxopts::ParseResult &result, bool shared_workspace)
+{
   if (!result["no-eval"].as<bool>()) {
-    evaluate_project_dependencies(workspace, project);
+    if (auto status = evaluate_project_dependencies(workspace, project, shared_workspace))
+      return status;
 
     if (!project.unknown_components.empty()) {
-      if (result["fetch"].as<bool>()) {
+      if (result["fetch"].as<bool>() && !shared_workspace) {
         download_unknown_components(workspace, project);
       } else {
         for (const auto &i: project.unknown_components)
           spdlog::error("Missing component '{}'", i);
+        if (shared_workspace)
+          return -1;
         spdlog::error("Try adding the '-f' command line option to automatically fetch components");
-        spdlog::shutdown();
-        exit(0);
+        return 0;
       }
     }
 
@@ -338,100 +582,23 @@ int main(int argc, char **argv)
 
   if (project.current_state != yakka::project::state::PROJECT_VALID && !result["ignore-eval"].as<bool>()) {
     spdlog::error("Project evaluation failed with state {}", static_cast<int>(project.current_state));
-    exit(-1);
-  }
-
-  // Insert additional command line data before processing blueprints
-  if (result["data"].count() != 0) {
-    spdlog::info("Processing additional data: {}", result["data"].as<std::string>());
-    const auto additional_data = "{" + result["data"].as<std::string>() + "}";
-    // ryml::Tree data       = ryml::parse_in_arena(ryml::to_csubstr(additional_data));
-    auto node = project.project_summary["temp"].append_child();
-    node |= ryml::MAP;
-    ryml::parse_in_arena(ryml::to_csubstr(additional_data), node);
-    yakka::merge_nodes(project.project_summary["data"], node);
-  }
-
-  t1 = std::chrono::high_resolution_clock::now();
-  project.process_blueprints();
-
-  project.save_blueprints();
-
-  // Ensure all the commands have a blueprint
-  spdlog::info("Checking for missing blueprints");
-  for (const auto &c: project.commands) {
-    if (project.blueprint_database.blueprints.contains(c))
-      continue;
-
-    // Find a component that has that blueprint
-    auto result = workspace.find_blueprint(c);
-    if (result) {
-      const auto blueprint_options = result.value();
-      if (blueprint_options.num_children() == 1) {
-        auto component_name = blueprint_options[0].val();
-        auto component_paths       = workspace.find_component(component_name);
-        if (component_paths) {
-          auto [component_path, db_path] = component_paths.value();
-          spdlog::info("Found a blueprint for {}: {}", c, component_path.string());
-          project.add_additional_tool(component_path);
-        } else {
-          spdlog::error("Could not find component for blueprint: {}", c);
-        }
-      } else {
-        spdlog::error("Multiple options for missing blueprint {}", c);
-        for (const auto &o: blueprint_options)
-          spdlog::error("- {}", o.val<std::string>().value());
-        return -1;
-      }
-    } else {
-      spdlog::info("Did not find a blueprint for {}", c);
-    }
-  }
-
-  try {
-    spdlog::debug("Generating target database");
-    project.generate_target_database();
-  } catch (const std::exception &e) {
-    spdlog::error("Failed to generate target database: {}", e.what());
-    return -1;
-  }
-  t2       = std::chrono::high_resolution_clock::now();
-  duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-  spdlog::info("{}ms to process blueprints", duration);
-
-  yakka::task_engine task_engine;
-  progress_bar_task_ui progress_bar_ui;
-  try {
-    task_engine.run_taskflow(project, &progress_bar_ui);
-  } catch (const std::exception &e) {
-    spdlog::error("Running task engine failed: {}", e.what());
     return -1;
   }
-
-  auto yakka_end_time = fs::file_time_type::clock::now();
-  std::cout << "Complete in " << std::chrono::duration_cast<std::chrono::milliseconds>(yakka_end_time - yakka_start_time).count() << " milliseconds" << std::endl;
-
-  spdlog::shutdown();
-  show_console_cursor(true);
-
-  if (task_engine.abort_build)
-    return -1;
-  else
-    return 0;
+  return std::nullopt;
 }
 
 /// @brief Executes evaluate_project_dependencies.
 
-static void evaluate_project_dependencies(yakka::workspace &workspace, yakka::project &project)
+static std::optional<int> evaluate_project_dependencies(yakka::workspace &workspace, yakka::project &project, bool shared_workspace)
 {
   auto t1 = std::chrono::high_resolution_clock::now();
 
 
   if (project.evaluate_dependencies() == yakka::project::state::PROJECT_HAS_INVALID_COMPONENT)
-    exit(1);
+    return 1;
 
   // If we're missing a component, update the component database and try again
-  if (!project.unknown_components.empty()) {
+  if (!project.unknown_components.empty() && !shared_workspace) {
     spdlog::info("Scanning workspace to find missing components");
     workspace.local_database.scan_for_components();
     workspace.shared_database.scan_for_components();
@@ -442,6 +609,7 @@ static void evaluate_project_dependencies(yakka::workspace &workspace, yakka::pr
   auto t2       = std::chrono::high_resolution_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
   spdlog::info("{}ms to process components", duration);
+  return std::nullopt;
 }
 
 /// @brief Executes print_project_choice_errors.
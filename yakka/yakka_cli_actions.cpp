@@ -5,6 +5,7 @@
 
 #include "yakka_cli_actions.hpp"
 #include "utilities.hpp"
+#include "affected.hpp"
 #include <indicators/dynamic_progress.hpp>
 #include <indicators/progress_bar.hpp>
 
@@ -202,6 +203,38 @@ int serve_action(workspace &workspace, const cxxopts::ParseResult &result)
   return 0;
 }
 
+/// @brief Executes affected_action.
+
+// Reports the projects and targets affected by the changed files given on the command line, or one per line on
+// stdin (e.g. `git diff --name-only | yakka affected`). Only state saved by previous builds is read.
+int affected_action(workspace &workspace, const cxxopts::ParseResult &result)
+{
+  auto t1 = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::string> changed_files;
+  const auto add_changed_file = [&](std::string_view path) {
+    if (!path.empty())
+      changed_files.push_back(workspace_relative_path(path, std::filesystem::current_path()));
+  };
+  if (result.unmatched().empty())
+    for (std::string line; std::getline(std::cin, line);)
+      add_changed_file(line);
+  else
+    for (const auto &f: result.unmatched())
+      add_changed_file(f);
+
+  const auto affected = find_affected_projects(default_output_directory, changed_files);
+  for (const auto &p: affected) {
+    std::cout << p.name << ":" << (p.rebuild_all ? " # all targets" : "") << "\n";
+    for (const auto &t: p.targets)
+      std::cout << "  - " << t << "\n";
+  }
+
+  auto t2 = std::chrono::high_resolution_clock::now();
+  spdlog::info("{}ms to find {} affected projects", std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count(), affected.size());
+  return 0;
+}
+
 // clang-format off
 // const std::unordered_map<std::string, action_handler> cli_actions = { 
 //   { "register", register_action }, 
@@ -6,17 +6,32 @@
 #include "yakka_component.hpp"
 // #include "yakka_schema.hpp"
 #include "utilities.hpp"
+#include "ryml_snapshot.hpp"
 #include "toml_parser_ryml.hpp"
 
 #include "spdlog/spdlog.h"
 #include "semver/semver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 #include <fstream>
+#include <format>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 using namespace semver::literals;
 
 namespace yakka {
 namespace {
 
+const semver::version yakka_version{
+#include "yakka_version.h"
+};
+
 /// @brief Executes has_component_toml_extension.
 
 bool has_component_toml_extension(const std::filesystem::path &file_path)
@@ -38,8 +53,99 @@ std::string component_id_from_path(const std::filesystem::path &file_path)
   return file_path.stem().string();
 }
 
+/// @brief Executes parse_component_version.
+
+semver::version parse_component_version(ryml::ConstNodeRef root)
+{
+  if (!root.has_child("version"))
+
+    return "0.0.0"_v;
+
+  auto version_node = root.find_child("version");
+  try {
+    return semver::version::parse(version_node.val<std::string>().value());
+  } catch (std::exception &e) {
+    spdlog::error("Failed to parse version: '{}'\n{}\n", version_node.val<std::string>().value(), e.what());
+    return "0.0.0"_v;
+  }
+}
+
+using snapshot_ptr = std::shared_ptr<const std::string>;
+
+// Snapshots keyed by cache key. An entry is added when a parse starts, so other threads wait for it instead of parsing too.
+std::mutex shared_snapshots_mutex;
+std::unordered_map<std::string, std::shared_future<snapshot_ptr>> shared_snapshots;
+
+// Snapshots in the cache directory, read from its count file on the first write and saved by component::save_cache_count()
+std::once_flag cache_count_loaded;
+std::atomic<size_t> cache_count = 0;
+std::atomic<bool> cache_count_changed = false;
+std::atomic_flag cache_pruning;
+
+/**
+ * @brief The right to produce the shared snapshot of one component.
+ *
+ * A claim that is released without publishing removes its entry, so the next thread parses the component itself.
+ */
+class snapshot_claim {
+public:
+  snapshot_claim() = default;
+  snapshot_claim(const snapshot_claim &) = delete;
+  snapshot_claim &operator=(const snapshot_claim &) = delete;
+  ~snapshot_claim()
+  {
+    if (!promise)
+      return;
+    promise->set_value(nullptr);
+    std::lock_guard lock(shared_snapshots_mutex);
+    shared_snapshots.erase(key);
+  }
+
+  /// @brief Executes acquire.
+
+  // Returns the snapshot of `snapshot_key`, waiting while another thread produces it. Returns nothing if this claim must produce it.
+  snapshot_ptr acquire(const std::string &snapshot_key)
+  {
+    std::shared_future<snapshot_ptr> pending;
+    {
+      std::lock_guard lock(shared_snapshots_mutex);
+      auto [entry, inserted] = shared_snapshots.try_emplace(snapshot_key);
+      if (inserted) {
+        key = snapshot_key;
+        promise.emplace();
+        entry->second = promise->get_future().share();
+        return nullptr;
+      }
+      pending = entry->second;
+    }
+    return pending.get();
+  }
+
+  [[nodiscard]] bool is_held() const noexcept
+  {
+    return promise.has_value();
+  }
+
+  /// @brief Executes publish.
+
+  void publish(snapshot_ptr snapshot)
+  {
+    if (!promise)
+      return;
+    promise->set_value(std::move(snapshot));
+    promise.reset();
+  }
+
+private:
+  std::string key;
+  std::optional<std::promise<snapshot_ptr>> promise;
+};
+
 } // namespace
 
+std::filesystem::path component::cache_directory;
+bool component::share_snapshots = false;
+
 /// @brief Executes parse_file.
 
 yakka_status component::parse_file(std::filesystem::path file_path, std::filesystem::path package_path, ryml::NodeRef parent_node)
@@ -48,6 +154,8 @@ yakka_status component::parse_file(std::filesystem::path file_path, std::filesys
 
   this->package_path      = package_path;
   std::string path_string = file_path.generic_string();
+  std::filesystem::path cache_file;
+  snapshot_claim claim;
   spdlog::info("Parsing '{}'", path_string);
 
   try {
@@ -59,12 +167,30 @@ yakka_status component::parse_file(std::filesystem::path file_path, std::filesys
     }
     yaml_buffer = std::move(result.value());
 
+    // The cached tree depends on the file contents, where it was found and the Yakka version
+    if (!parent_node.valid() && (share_snapshots || !cache_directory.empty())) {
+      const auto key = content_digest(std::format("{}\n{}\n{}\n{}\n{}", yakka_version.str(), yakka_schema_validator::schema_digest(), path_string, package_path.generic_string(), content_digest(yaml_buffer)));
+      if (share_snapshots)
+        if (auto snapshot = claim.acquire(key); snapshot && load_snapshot(snapshot))
+          return yakka_status::SUCCESS;
+      if (!cache_directory.empty()) {
+        cache_file = cache_directory / (key + ".bin");
+        if (load_cached_tree(cache_file)) {
+          claim.publish(snapshot_buffer);
+          return yakka_status::SUCCESS;
+        }
+      }
+    }
+
     const bool is_toml_component = has_component_toml_extension(file_path);
 
     if (is_toml_component) {
+      // TOML scalars are all stored in the arena of the parsed tree, so the file contents are no longer needed
       tree = toml_ryml::parse_toml(yaml_buffer, path_string);
+      std::string{}.swap(yaml_buffer);
       if (parent_node.valid()) {
-        merge_nodes(parent_node, tree.crootref());
+        ryml_copy(parent_node, tree.crootref());
+        tree = ryml::Tree{};
         root = parent_node;
       } else {
         root = tree.rootref();
@@ -145,17 +271,7 @@ yakka_status component::parse_file(std::filesystem::path file_path, std::filesys
     dir_node << path_string;
 
     // Set version
-    if (root.has_child("version")) {
-      auto version_node = root.find_child("version");
-      try {
-        this->version = semver::version::parse(version_node.val<std::string>().value());
-      } catch (std::exception &e) {
-        spdlog::error("Failed to parse version: '{}'\n{}\n", version_node.val<std::string>().value(), e.what());
-        this->version = "0.0.0"_v;
-      }
-    } else {
-      this->version = "0.0.0"_v;
-    }
+    this->version = parse_component_version(root);
 
     // Ensure certain nodes are sequences
     if (root.has_child("requires")) {
@@ -259,9 +375,189 @@ yakka_status component::parse_file(std::filesystem::path file_path, std::filesys
   // json = ryml_to_json(tree.rootref());
   // json_cache_valid = true;
 
+  if (!cache_file.empty() || claim.is_held()) {
+    auto snapshot = std::make_shared<const std::string>(ryml_snapshot(root));
+    if (!cache_file.empty()) {
+      auto saved = save_file_if_changed(cache_file, *snapshot);
+      if (!saved)
+        spdlog::debug("Failed to cache '{}': {}", path_string, saved.error().message());
+      else if (saved.value())
+        count_cached_snapshot();
+    }
+    claim.publish(std::move(snapshot));
+  }
+
   return yakka_status::SUCCESS;
 }
 
+/// @brief Executes cache_subdirectory.
+
+// Each yakka version and schema has its own cache, so stale snapshots can be removed as a whole
+std::filesystem::path component::cache_subdirectory()
+{
+  return content_digest(yakka_version.str() + "\n" + yakka_schema_validator::schema_digest()).substr(0, 16);
+}
+
+/// @brief Executes remove_stale_caches.
+
+// Removes caches of other versions that have not been written for a while. Only the cache root is listed.
+void component::remove_stale_caches()
+{
+  if (cache_directory.empty())
+    return;
+
+  namespace fs = std::filesystem;
+
+  const auto cutoff = fs::file_time_type::clock::now() - std::chrono::days(component_cache_max_age_days);
+  const auto root   = cache_directory.parent_path();
+  std::error_code ec;
+  for (const auto &entry: fs::directory_iterator(root, ec)) {
+    if (entry.path() == cache_directory)
+      continue;
+    std::error_code entry_ec;
+    // Snapshots saved directly in the root predate the per-version caches
+    if (!entry.is_directory(entry_ec) || entry.last_write_time(entry_ec) < cutoff)
+      fs::remove_all(entry.path(), entry_ec);
+  }
+}
+
+/// @brief Executes prune_cache.
+
+// Trims the current cache to the most recently used snapshots. Loading a snapshot touches it, so the
+// time of each snapshot is when it was last written or loaded.
+void component::prune_cache()
+{
+  if (cache_directory.empty())
+    return;
+
+  namespace fs = std::filesystem;
+
+  std::error_code ec;
+  std::vector<std::pair<fs::file_time_type, fs::path>> snapshots;
+  for (const auto &entry: fs::directory_iterator(cache_directory, ec)) {
+    std::error_code entry_ec;
+    const auto time = entry.last_write_time(entry_ec);
+    if (!entry_ec && entry.path().extension() == ".bin")
+      snapshots.emplace_back(time, entry.path());
+  }
+  cache_count         = snapshots.size();
+  cache_count_changed = true;
+  if (snapshots.size() <= component_cache_limit)
+    return;
+
+  // Keep the newest three quarters of the limit so pruning does not run on every write
+  const auto keep = component_cache_limit * 3 / 4;
+  std::ranges::nth_element(snapshots, snapshots.begin() + (snapshots.size() - keep));
+  for (auto it = snapshots.begin(); it != snapshots.begin() + (snapshots.size() - keep); ++it)
+    fs::remove(it->second, ec);
+  cache_count = keep;
+  spdlog::info("Pruned {} cached components", snapshots.size() - keep);
+}
+
+/// @brief Executes count_cached_snapshot.
+
+// Counts a snapshot newly written to the cache and prunes the cache once the count is over component_cache_limit.
+// The count is an estimate, as other processes may write to the same cache, and pruning corrects it.
+void component::count_cached_snapshot()
+{
+  std::call_once(cache_count_loaded, [] {
+    size_t count = 0;
+    auto saved   = get_file_contents<std::string>(cache_directory / component_cache_count_filename);
+    if (!saved || std::from_chars(saved->data(), saved->data() + saved->size(), count).ec != std::errc{}) {
+      // Without a saved count the cache is listed once to start one
+      std::error_code ec;
+      count = 0;
+      for (const auto &entry: std::filesystem::directory_iterator(cache_directory, ec))
+        if (entry.path().extension() == ".bin")
+          ++count;
+    }
+    cache_count = count;
+  });
+
+  cache_count_changed = true;
+  if (++cache_count > component_cache_limit && !cache_pruning.test_and_set()) {
+    prune_cache();
+    cache_pruning.clear();
+  }
+}
+
+/// @brief Executes save_cache_count.
+
+void component::save_cache_count()
+{
+  if (cache_directory.empty() || !cache_count_changed.exchange(false))
+    return;
+
+  auto saved = save_file_if_changed(cache_directory / component_cache_count_filename, std::to_string(cache_count.load()));
+  if (!saved)
+    spdlog::debug("Failed to save the component cache count: {}", saved.error().message());
+}
+
+/// @brief Executes load_cached_tree.
+
+bool component::load_cached_tree(const std::filesystem::path &cache_file)
+{
+  auto cached = get_file_contents<std::string>(cache_file);
+
+  if (!cached)
+    return false;
+  if (!load_snapshot(std::make_shared<const std::string>(std::move(cached.value())))) {
+    spdlog::debug("Ignoring invalid component cache '{}'", cache_file.generic_string());
+    return false;
+  }
+
+  // Mark the snapshot as used so prune_cache() keeps it
+  std::error_code ec;
+  std::filesystem::last_write_time(cache_file, std::filesystem::file_time_type::clock::now(), ec);
+  return true;
+}
+
+/// @brief Executes load_snapshot.
+
+bool component::load_snapshot(std::shared_ptr<const std::string> snapshot)
+{
+  // Loaded scalars are views into the snapshot, which is held for the life of the component
+  tree.clear();
+
+  tree.rootref() |= ryml::SEQ;
+  auto loaded = ryml_load_snapshot(*snapshot, tree.rootref());
+  // The snapshot must be complete and describe this file, not just any component
+  if (!loaded || !loaded.value().is_map() || !loaded.value().has_child("id") || !loaded.value().has_child("directory") || !loaded.value().has_child("yakka_file")
+      || loaded.value()["yakka_file"].val() != c4::to_csubstr(file_path.string())) {
+    tree.clear();
+    return false;
+  }
+  snapshot_buffer = std::move(snapshot);
+  std::string{}.swap(yaml_buffer);
+
+  root = loaded.value();
+  restore_metadata();
+  return true;
+}
+
+/// @brief Executes restore_metadata.
+
+// Sets the ID, directory, type and version of a component whose processed root was stored earlier
+void component::restore_metadata()
+{
+  id = root["id"].val();
+  if (root.has_child("directory"))
+    component_path = root["directory"].val<std::string>().value();
+  else
+    component_path = file_path.parent_path();
+  const auto extension = file_path.filename().extension();
+  if (extension == slce_component_extension)
+    type = SLCE_FILE;
+  else if (extension == slcc_component_extension)
+    type = SLCC_FILE;
+  else if (extension == slcp_component_extension)
+    type = SLCP_FILE;
+  else {
+    type    = YAKKA_FILE;
+    version = parse_component_version(root);
+  }
+}
+
 /// @brief Executes convert_to_yakka.
 
 void component::convert_to_yakka()
@@ -11,11 +11,15 @@
 #include <string>
 #include <iostream>
 #include <filesystem>
+#include <memory>
 
 namespace yakka {
 
 struct component {
   yakka_status parse_file(std::filesystem::path file_path, std::filesystem::path package_path = {}, ryml::NodeRef parent_node = {});
+  bool load_cached_tree(const std::filesystem::path &cache_file);
+  bool load_snapshot(std::shared_ptr<const std::string> snapshot);
+  void restore_metadata();
   //std::tuple<component_list_t &, feature_list_t &> apply_feature(std::string feature_name);
   //std::tuple<component_list_t &, feature_list_t &> process_requirements(const ryml::Tree &node);
   component_list_t get_required_components();
@@ -28,11 +32,13 @@ struct component {
   std::filesystem::path file_path;
   std::filesystem::path component_path;
   
-  // - tree: May be unused if parent_node provided during parsing
-  // - yaml_buffer: Buffer to hold YAML file contents (ryml uses views into this)
+  // - tree: May be unused if parent_node provided during parsing, released once merged into a project
+  // - yaml_buffer: Buffer to hold YAML file contents (ryml and the project summary use views into this)
   ryml::Tree tree;
   std::string yaml_buffer;
+  std::shared_ptr<const std::string> snapshot_buffer; // Holds the scalars of a component loaded from its cached snapshot
   ryml::NodeRef root; // Root node reference for easy access
+  ryml::NodeRef parsed_root; // Root within `tree` once merged into a project, kept until the tree is released
   ryml::NodeRef blueprints; // Helper reference to blueprints node for easy access
   
   semver::version version;
@@ -40,6 +46,16 @@ struct component {
   // Optional path to package
   std::filesystem::path package_path;
 
+  // Directory of parsed component snapshots keyed by content digest, empty disables the cache
+  static std::filesystem::path cache_directory;
+  static std::filesystem::path cache_subdirectory();
+  static void remove_stale_caches();
+  static void prune_cache();
+  static void count_cached_snapshot();
+  static void save_cache_count();
+  // Keep snapshots in memory so projects evaluated in the same process parse each component once, even without a cache directory
+  static bool share_snapshots;
+
   enum {
     YAKKA_FILE,
     SLCC_FILE,
@@ -7,9 +7,11 @@
 #include "yakka_project.hpp"
 #include "yakka_schema.hpp"
 #include "utilities.hpp"
+#include "ryml_snapshot.hpp"
 
 #include "spdlog/spdlog.h"
 #include "glob/glob.h"
+#include "algorithm/for_each.hpp"
 // #include <ryml/json-schema.hpp>
 #include <ryml.hpp>
 #include <ryml_std.hpp>
@@ -18,6 +20,8 @@
 #include <thread>
 #include <string>
 #include <charconv>
+#include <set>
+#include <deque>
 
 using namespace std;
 
@@ -26,7 +30,10 @@ using namespace std::chrono_literals;
 
 /// @brief Executes project.
 
-project::project(yakka::workspace &workspace, const std::string project_name) : project_name(project_name), yakka_home_directory("/.yakka"), project_directory("."), workspace(workspace)
+project::project(yakka::workspace &workspace, const std::string project_name)
+    : project_name(project_name), yakka_home_directory("/.yakka"), unprocessed_components(symbols), unprocessed_features(symbols), required_components(symbols),
+      required_features(symbols), provided_features(symbols), unprovided_features(symbols), unknown_components(symbols), project_directory("."),
+      workspace(workspace), slc_required(symbols), slc_provided(symbols)
 {
   // abort_build      = false;
 
@@ -35,8 +42,8 @@ project::project(yakka::workspace &workspace, const std::string project_name) :
   component_flags  = component_database::flag::ALL_COMPONENTS;
 
   // Setup the project data
-  project_data.reserve_arena(16 * 1024 * 1024);               // Pre-allocate 16MB for the project data to avoid ANY reallocations
-  project_data.add_flags(ryml::Tree::TREEF_NO_ARENA_REALLOC); // Forbid arena reallocations to ensure pointer stability
+  project_data.reserve_arena(yakka::project_arena_chunk_size);                                     // Pre-allocate the first arena chunk for the project data
+  project_data.add_flags(ryml::Tree::TREEF_NO_ARENA_REALLOC | ryml::Tree::TREEF_CHUNKED_ARENA); // Grow by adding chunks so csubstrs are never relocated
   project_data.rootref() |= ryml::MAP;
 
   if (!project_name.empty()) {
@@ -51,6 +58,7 @@ project::project(yakka::workspace &workspace, const std::string project_name) :
 
   template_contributions = project_data.rootref().append_child() << ryml::key("template_contributions");
   template_contributions |= ryml::MAP;
+  contribution_sources = template_contributions;
 
   project_data["initial_features"] |= ryml::SEQ;
   project_data["initial_components"] |= ryml::SEQ;
@@ -162,9 +170,26 @@ void project::init_project()
 
   if (fs::exists(project_summary_file)) {
     project_summary_last_modified = fs::last_write_time(project_summary_file);
-    auto file_content             = yakka::get_file_contents<std::string>(project_summary_file);
-    if (file_content) {
+
+    // Prefer the binary snapshot, which is loaded without parsing, and fall back to the YAML when the
+    // snapshot is older, as the YAML was edited or written by an older yakka
+    const auto snapshot_file = output_path / yakka::project_snapshot_filename;
+    bool loaded_snapshot     = false;
+    if (!is_up_to_date(snapshot_file, project_summary_file))
+      spdlog::info("Summary snapshot '{}' is older than the summary", snapshot_file.generic_string());
+    else if (summary_snapshot.open(snapshot_file)) {
+      loaded_snapshot = ryml_load_snapshot(summary_snapshot.contents(), project_data.rootref()).has_value();
+      if (!loaded_snapshot) {
+        spdlog::info("Ignoring invalid summary snapshot '{}'", snapshot_file.generic_string());
+        summary_snapshot.close();
+      }
+    }
+    if (loaded_snapshot) {
+      cached_summary  = project_data.rootref().last_child();
+      project_summary = project_data["current"];
+    } else if (auto file_content = yakka::get_file_contents<std::string>(project_summary_file); file_content) {
       ryml::parse_in_arena(ryml::to_csubstr(*file_content), project_data.rootref());
+      cached_summary  = project_data.rootref().last_child();
       project_summary = project_data["current"];
     }
     // auto result                   = ryml_load_file(project_summary_file);
@@ -218,7 +243,14 @@ void project::process_requirements(std::shared_ptr<yakka::component> component,
 
   // Merge the feature values into the parent component
   // json_node_merge(ryml::Pointer(""), component->root, child_node, &project_schema);
-  merge_nodes(component->root, child_node);
+  ryml_merge(component->root, child_node);
+
+  // Supports merged into the component must be found when their targets are added later
+  if (child_node.has_child("supports")) {
+    const auto position = std::ranges::find(components, component) - components.begin();
+    if (position < static_cast<std::ptrdiff_t>(components.size()))
+      index_supports(position, child_node);
+  }
 
   // Process required components
   if (child_node.contains(_requires_components_pointer)) {
@@ -350,6 +382,28 @@ bool project::add_component(std::string &component_name, component_database::fla
 /// @brief Executes add_component.
 
 bool project::add_component(c4::csubstr component_name, component_database::flag flags)
+{
+  const auto location = resolve_component(component_name, flags);
+
+  if (!location)
+    return false;
+
+  auto new_component = take_retained_component(location->symbol);
+  if (!new_component) {
+    new_component = std::make_shared<yakka::component>();
+    if (new_component->parse_file(location->path, location->package_path) != yakka::yakka_status::SUCCESS) {
+      required_components.insert(location->symbol);
+      current_state = project::state::PROJECT_HAS_INVALID_COMPONENT;
+      return false;
+    }
+  }
+
+  return integrate_component(location.value(), new_component);
+}
+
+/// @brief Executes resolve_component.
+
+std::optional<project::component_location> project::resolve_component(c4::csubstr component_name, component_database::flag flags)
 {
   // Convert string to id
 
@@ -359,32 +413,69 @@ bool project::add_component(c4::csubstr component_name, component_database::flag
   if (replacements.contains(component_id)) {
     spdlog::info("Skipping {}. Being replaced by {}", component_id, replacements[component_id]);
     unprocessed_components.insert(replacements[component_id]);
-    return false;
+    return {};
   }
 
   // Find the component in the project component database
-  auto component_location = workspace.find_component(component_id, flags);
-  if (!component_location) {
+  auto found = workspace.find_component(component_id, flags);
+  if (!found) {
     // spdlog::info("{}: Couldn't find it", c);
     unknown_components.insert(component_id);
-    return false;
+    return {};
   }
 
-  // Add component to the required list and continue if this is not a new component
-  // Insert component and continue if this is not new
-  if (required_components.insert(component_id).second == false)
-    return false;
+  // Nothing to do if this is not a new component
+  const auto symbol = symbols.intern(component_id);
+  if (required_components.contains(symbol))
+    return {};
+
+  auto [component_path, package_path] = found.value();
+  return component_location{ symbols.name(symbol), component_path, package_path, symbol };
+}
+
+/// @brief Executes merge_component.
+
+void project::merge_component(c4::csubstr key, const std::shared_ptr<yakka::component> &new_component)
+{
+  auto new_component_node = project_summary["components"].append_child() << ryml::key(key);
 
-  auto [component_path, package_path]             = component_location.value();
-  std::shared_ptr<yakka::component> new_component = std::make_shared<yakka::component>();
-  auto new_component_node                         = project_summary["components"].append_child() << ryml::key(component_id);
   new_component_node |= ryml::MAP;
-  if (new_component->parse_file(component_path, package_path, new_component_node) == yakka::yakka_status::SUCCESS) {
-    components.push_back(new_component);
-  } else {
-    current_state = project::state::PROJECT_HAS_INVALID_COMPONENT;
+  ryml_copy(new_component_node, new_component->root);
+  new_component->parsed_root = new_component->root;
+  new_component->root        = new_component_node;
+  new_component->id          = new_component_node.has_child("id") ? new_component_node["id"].val() : new_component_node.key();
+  // Note: grafted scalars still refer to the component's buffer, the parsed tree is released by release_parsed_trees()
+}
+
+/// @brief Executes release_parsed_trees.
+
+void project::release_parsed_trees()
+{
+  // Once resolution has settled the summary nodes hold the structure, so the private trees can go
+
+  for (auto &c: components)
+    if (c->parsed_root.valid()) {
+      c->tree        = ryml::Tree{};
+      c->parsed_root = ryml::NodeRef{};
+    }
+
+  // Components parsed ahead that resolution never added are not needed any more
+  retained_components.clear();
+}
+
+/// @brief Executes integrate_component.
+
+bool project::integrate_component(const component_location &location, std::shared_ptr<yakka::component> new_component)
+{
+  const auto component_id = location.id;
+
+  // Add component to the required list and continue if this is not a new component
+  if (required_components.insert(location.symbol).second == false)
     return false;
-  }
+
+  merge_component(component_id, new_component);
+  components.push_back(new_component);
+  index_supports(components.size() - 1, new_component->root);
 
   // Add special processing of SLC related files and data
   if (new_component->type == yakka::component::YAKKA_FILE) {
@@ -491,13 +582,17 @@ bool project::add_component(c4::csubstr component_name, component_database::flag
       }
     } else {
       spdlog::info("{} replaces {}", ryml_string(component_id), replaced);
-      unprocessed_replacements.insert({ replaced, component_id });
+      // Requests can be redirected straight away if nothing has added the replaced component yet
+      if (!required_components.contains(replaced))
+        replacements.insert({ replaced, component_id });
+      else
+        unprocessed_replacements.insert({ replaced, component_id });
     }
   }
 
   // Process all the currently required features. Note new feature will be processed in the features pass
   if (new_component->root.contains(_supports_features_pointer)) {
-    for (auto &f: required_features)
+    for (const auto f: required_features)
       if (new_component->root["supports"]["features"].has_child(f)) {
         spdlog::info("Processing required feature '{}' in {}", ryml_string(f), component_id);
         process_requirements(new_component, new_component->root["supports"]["features"][f]);
@@ -505,7 +600,7 @@ bool project::add_component(c4::csubstr component_name, component_database::flag
   }
   if (new_component->root.contains(_supports_components_pointer)) {
     // Process the new components support for all the currently required components
-    for (auto &c: required_components)
+    for (const auto c: required_components)
       if (new_component->root["supports"]["components"].has_child(c)) {
         spdlog::info("Processing required component '{}' in {}", ryml_string(c), component_id);
         process_requirements(new_component, new_component->root["supports"]["components"][c]);
@@ -521,33 +616,366 @@ bool project::add_component(c4::csubstr component_name, component_database::flag
   }
 
   // Process all the existing components support for the new component
-  for (auto &c: components)
-    if (c->root.contains(_supports_components_pointer / component_id)) {
-      spdlog::info("Processing component '{}' in {}", component_id, c->root["name"].val<std::string>().value());
-      process_requirements(c, c->root["supports"]["components"][component_id]);
+  if (const auto supporters = component_supporters.find(component_id); supporters != component_supporters.end())
+    for (const auto n: std::set<size_t>(supporters->second)) {
+      const auto c = components[n];
+      if (c->root.contains(_supports_components_pointer / component_id)) {
+        spdlog::info("Processing component '{}' in {}", component_id, c->root["name"].val<std::string>().value());
+        process_requirements(c, c->root["supports"]["components"][component_id]);
+      }
     }
 
   return true;
 }
 
+/// @brief Executes take_retained_component.
+
+std::shared_ptr<yakka::component> project::take_retained_component(c4::csubstr component_id)
+{
+  const auto symbol = symbols.find(component_id);
+
+  return symbol ? take_retained_component(symbol.value()) : nullptr;
+}
+
+/// @brief Executes take_retained_component.
+
+std::shared_ptr<yakka::component> project::take_retained_component(symbol_table::symbol_id symbol)
+{
+  auto retained = retained_components.find(symbol);
+  if (retained == retained_components.end())
+    return nullptr;
+
+  // Grafting only reads the parsed tree, so it still holds the component as it was parsed
+  auto c = std::move(retained->second);
+  if (c->parsed_root.valid())
+    c->root = c->parsed_root;
+  retained_components.erase(retained);
+  return c;
+}
+
+/// @brief Executes get_executor.
+
+tf::Executor &project::get_executor()
+{
+  if (executor == nullptr) {
+
+    owned_executor = std::make_unique<tf::Executor>(std::min(32U, std::thread::hardware_concurrency()));
+    executor       = owned_executor.get();
+  }
+  return *executor;
+}
+
+/// @brief Executes parse_components.
+
+std::vector<std::shared_ptr<yakka::component>> project::parse_components(const std::vector<component_location> &locations)
+{
+  // Each component is parsed into its own tree, failures are left empty
+
+  std::vector<std::shared_ptr<yakka::component>> parsed(locations.size());
+  const auto parse_component = [&](size_t n) {
+    auto new_component = std::make_shared<yakka::component>();
+    if (new_component->parse_file(locations[n].path, locations[n].package_path) == yakka::yakka_status::SUCCESS)
+      parsed[n] = new_component;
+  };
+  if (locations.size() > 1) {
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(size_t{ 0 }, locations.size(), size_t{ 1 }, parse_component);
+    get_executor().run(taskflow).wait();
+  } else if (locations.size() == 1) {
+    parse_component(0);
+  }
+  return parsed;
+}
+
+/// @brief Executes preload_components.
+
+void project::preload_components()
+{
+  // Follow the unconditional component requirements recorded in the component index. Conditional
+  // requirements depend on the features and components chosen during resolution, so those are
+  // still loaded wave by wave.
+
+  std::vector<component_location> selected;
+  std::unordered_set<std::string> visited;
+  std::vector<std::string> pending;
+  for (const auto c: unprocessed_components)
+    pending.emplace_back(c.str, c.len);
+
+  while (!pending.empty()) {
+    const auto name = std::move(pending.back());
+    pending.pop_back();
+
+    const auto component_id = component_dotname_to_id(c4::to_csubstr(name));
+    if (!visited.emplace(component_id.str, component_id.len).second || replacements.contains(component_id))
+      continue;
+    const auto symbol = symbols.intern(component_id);
+    if (required_components.contains(symbol))
+      continue;
+
+    const auto found = workspace.find_component(component_id, component_flags);
+    if (!found)
+      continue;
+    const auto metadata = workspace.find_component_metadata(found->first);
+    if (!metadata)
+      continue;
+
+    if (!retained_components.contains(symbol))
+      selected.push_back({ symbols.name(symbol), found->first, found->second, symbol });
+
+    if (!metadata->has_child("requires") || !metadata.value()["requires"].has_child("components"))
+      continue;
+
+    // Relative requirements are prefixed with the component directory, as in component::parse_file()
+    const auto directory = found->first.parent_path().generic_string();
+    const auto add_requirement = [&](ryml::ConstNodeRef r) {
+      if (!r.has_val())
+        return;
+      std::string requirement(r.val().str, r.val().len);
+      if (!requirement.empty() && requirement.front() == '.')
+        requirement = directory + requirement;
+      pending.push_back(std::move(requirement));
+    };
+    const auto requires_node = metadata.value()["requires"]["components"];
+    if (requires_node.is_seq())
+      for (const auto &r: requires_node.children())
+        add_requirement(r);
+    else
+      add_requirement(requires_node);
+  }
+
+  if (selected.size() < 2)
+    return;
+
+  const auto parsed = parse_components(selected);
+  for (size_t n = 0; n < selected.size(); ++n)
+    if (parsed[n])
+      retained_components.insert({ selected[n].symbol, parsed[n] });
+}
+
+/// @brief Executes prefetch_components.
+
+std::vector<symbol_table::symbol_id> project::prefetch_components(const symbol_set &names)
+{
+  // Parse the components a wave is likely to add into the retained set, without resolving them.
+  // Failed parses are left for add_component() to report. Returns the symbols that were retained.
+
+  std::vector<component_location> selected;
+  std::unordered_set<c4::csubstr> seen;
+  for (const auto name: names) {
+    const auto component_id = component_dotname_to_id(name);
+    if (!seen.insert(component_id).second || replacements.contains(component_id))
+      continue;
+
+    const auto symbol = symbols.intern(component_id);
+    if (required_components.contains(symbol) || retained_components.contains(symbol))
+      continue;
+    if (const auto found = workspace.find_component(component_id, component_flags))
+      selected.push_back({ symbols.name(symbol), found->first, found->second, symbol });
+  }
+
+  std::vector<symbol_table::symbol_id> prefetched;
+  if (selected.size() < 2)
+    return prefetched;
+
+  const auto parsed = parse_components(selected);
+  for (size_t n = 0; n < selected.size(); ++n)
+    if (parsed[n] && retained_components.insert({ selected[n].symbol, parsed[n] }).second)
+      prefetched.push_back(selected[n].symbol);
+  return prefetched;
+}
+
+/// @brief Executes index_supports.
+
+void project::index_supports(size_t position, ryml::ConstNodeRef node)
+{
+  if (!node.has_child("supports"))
+
+    return;
+
+  const auto supports = node["supports"];
+  if (supports.has_child("components") && supports["components"].is_map())
+    for (const auto &c: supports["components"].children())
+      component_supporters[c.key()].insert(position);
+  if (supports.has_child("features") && supports["features"].is_map())
+    for (const auto &f: supports["features"].children())
+      feature_supporters[f.key()].insert(position);
+}
+
+/// @brief Executes retract_components.
+
+// Removes replaced components, and the components only they required, so resolution continues without a restart.
+// Returns false and leaves the project unchanged when another component merged `supports` data for something that
+// would be removed, or a removed component added state that cannot be taken back.
+bool project::retract_components(const std::vector<c4::csubstr> &replaced)
+{
+  // Visits the component or feature IDs listed under `requires` or `provides` of a summary node
+  const auto for_each_listed = [](ryml::ConstNodeRef node, c4::csubstr group, c4::csubstr kind, const auto &visit) {
+    if (!node.has_child(group) || !node[group].has_child(kind))
+      return;
+    const auto list = node[group][kind];
+    if (list.has_val())
+      visit(list.val());
+    for (const auto item: list.children())
+      if (item.has_val())
+        visit(item.val());
+      else if (item.is_map() && item.has_child("name"))
+        visit(item["name"].val());
+  };
+
+  std::unordered_map<c4::csubstr, size_t> positions;
+  for (size_t n = 0; n < components.size(); ++n)
+    positions.insert({ components[n]->root.key(), n });
+
+  // Visits the positions of the components a component requires
+  const auto for_each_requirement = [&](size_t position, const auto &visit) {
+    for_each_listed(components[position]->root, "requires", "components", [&](c4::csubstr name) {
+      if (const auto found = positions.find(component_dotname_to_id(name)); found != positions.end())
+        visit(found->second);
+    });
+  };
+
+  // Marks everything reachable from `pending`, never entering a replaced component
+  std::unordered_set<c4::csubstr> replaced_ids(replaced.begin(), replaced.end());
+  const auto mark = [&](std::vector<size_t> pending, std::vector<bool> &marked) {
+    while (!pending.empty()) {
+      const auto n = pending.back();
+      pending.pop_back();
+      if (marked[n] || replaced_ids.contains(components[n]->root.key()))
+        continue;
+      marked[n] = true;
+      for_each_requirement(n, [&](size_t r) {
+        pending.push_back(r);
+      });
+    }
+  };
+
+  // Only components required through a replaced component can become unused
+  std::vector<bool> candidates(components.size(), false);
+  std::vector<size_t> pending;
+  for (const auto id: replaced)
+    if (const auto found = positions.find(id); found != positions.end()) {
+      candidates[found->second] = true;
+      for_each_requirement(found->second, [&](size_t r) {
+        pending.push_back(r);
+      });
+    }
+  mark(std::move(pending), candidates);
+
+  // Everything else stays, along with what it, the initial components and feature recommendations require
+  std::vector<bool> kept(components.size(), false);
+  pending.clear();
+  for (size_t n = 0; n < components.size(); ++n)
+    if (!candidates[n])
+      pending.push_back(n);
+  for (const auto id: initial_components)
+    if (const auto found = positions.find(component_dotname_to_id(id)); found != positions.end())
+      pending.push_back(found->second);
+  for (const auto &[feature, recommendation]: feature_recommendations)
+    if (required_features.contains(feature) && recommendation.has_child("component"))
+      if (const auto found = positions.find(component_dotname_to_id(recommendation["component"].val())); found != positions.end())
+        pending.push_back(found->second);
+  mark(std::move(pending), kept);
+
+  std::vector<bool> retracted(components.size(), false);
+  for (size_t n = 0; n < components.size(); ++n)
+    retracted[n] = candidates[n] && !kept[n];
+  const auto has_remaining_supporter = [&](const std::unordered_map<c4::csubstr, std::set<size_t>> &supporters, c4::csubstr id) {
+    const auto found = supporters.find(id);
+    return found != supporters.end() && std::ranges::any_of(found->second, [&](size_t n) {
+             return !retracted[n];
+           });
+  };
+
+  // Features stay required while a remaining component or the project requires them
+  std::unordered_set<c4::csubstr> kept_features(initial_features.begin(), initial_features.end());
+  std::unordered_set<c4::csubstr> kept_provided;
+  for (size_t n = 0; n < components.size(); ++n)
+    if (!retracted[n]) {
+      for_each_listed(components[n]->root, "requires", "features", [&](c4::csubstr f) {
+        kept_features.insert(f);
+      });
+      for_each_listed(components[n]->root, "provides", "features", [&](c4::csubstr f) {
+        kept_provided.insert(f);
+      });
+    }
+
+  std::unordered_set<c4::csubstr> retracted_features;
+  std::unordered_set<c4::csubstr> retracted_provided;
+  for (size_t n = 0; n < components.size(); ++n) {
+    if (!retracted[n])
+      continue;
+    const auto node = components[n]->root;
+    if (components[n]->type != yakka::component::YAKKA_FILE || node.has_child("choices") || node.has_child("schema") || node.has_child("data_schema")
+        || node.has_child("replaces") || has_remaining_supporter(component_supporters, node.key()))
+      return false;
+    for_each_listed(node, "requires", "features", [&](c4::csubstr f) {
+      if (!kept_features.contains(f))
+        retracted_features.insert(f);
+    });
+    for_each_listed(node, "provides", "features", [&](c4::csubstr f) {
+      if (!kept_provided.contains(f))
+        retracted_provided.insert(f);
+    });
+  }
+  for (const auto f: retracted_features)
+    if (has_remaining_supporter(feature_supporters, f))
+      return false;
+
+  // Nothing that remains depends on what is removed, so take it out
+  for (const auto f: retracted_features) {
+    required_features.erase(f);
+    unprovided_features.erase(f);
+  }
+  for (const auto f: retracted_provided) {
+    provided_features.erase(f);
+    if (required_features.contains(f))
+      unprovided_features.insert(f);
+  }
+
+  std::vector<std::shared_ptr<yakka::component>> remaining;
+  remaining.reserve(components.size());
+  for (size_t n = 0; n < components.size(); ++n) {
+    if (!retracted[n]) {
+      remaining.push_back(std::move(components[n]));
+      continue;
+    }
+    const auto key = components[n]->root.key();
+    spdlog::info("Retracting {}", key);
+    required_components.erase(key);
+    project_summary["components"].remove_child(key);
+  }
+  components = std::move(remaining);
+
+  // The supporter indexes hold positions in `components`, which have moved
+  component_supporters.clear();
+  feature_supporters.clear();
+  for (size_t n = 0; n < components.size(); ++n)
+    index_supports(n, components[n]->root);
+  return true;
+}
+
 /// @brief Executes add_feature.
 
 bool project::add_feature(c4::csubstr &feature_name)
 {
   // Insert feature and continue if this is not new
 
-  if (required_features.insert(feature_name).second == false)
+  const auto symbol = symbols.intern(feature_name);
+  if (required_features.insert(symbol).second == false)
     return false;
 
-  if (!provided_features.contains(feature_name)) {
-    unprovided_features.insert(feature_name);
+  if (!provided_features.contains(symbol)) {
+    unprovided_features.insert(symbol);
   }
 
   // Process the feature "supports" for each existing component
-  for (auto &c: components)
-    if (c->root.contains(_supports_features_pointer / feature_name)) {
-      spdlog::info("Processing feature '{}' in {}", feature_name, c->root["name"].val<std::string>().value());
-      process_requirements(c, c->root["supports"]["features"][feature_name]);
+  if (const auto supporters = feature_supporters.find(feature_name); supporters != feature_supporters.end())
+    for (const auto n: std::set<size_t>(supporters->second)) {
+      const auto c = components[n];
+      if (c->root.contains(_supports_features_pointer / feature_name)) {
+        spdlog::info("Processing feature '{}' in {}", feature_name, c->root["name"].val<std::string>().value());
+        process_requirements(c, c->root["supports"]["features"][feature_name]);
+      }
     }
 
   return true;
@@ -631,11 +1059,18 @@ project::state project::evaluate_dependencies()
 {
   //project_has_slcc = false;
 
+  // Load every component the index says will be needed in one parallel batch
+  preload_components();
+
   // Start processing all the required components and features
   while (!unprocessed_components.empty() || !unprocessed_features.empty() || !slc_required.empty()) {
     // Loop through the list of unprocessed components.
     // Note: Items will be added to unprocessed_components during processing
-    component_list_t temp_component_list = std::move(unprocessed_components);
+    auto temp_component_list = std::move(unprocessed_components);
+
+    // Parse the wave concurrently ahead of adding it. Each component is still resolved and added in
+    // order, so a replacement declared earlier in the wave applies exactly as in a serial pass.
+    const auto prefetched = prefetch_components(temp_component_list);
     for (auto i: temp_component_list) {
       // Try add the component
       if (!add_component(i, component_flags)) {
@@ -644,9 +1079,13 @@ project::state project::evaluate_dependencies()
       }
     }
 
+    // Anything prefetched for this wave but not added, e.g. a replaced component, is dropped
+    for (const auto symbol: prefetched)
+      retained_components.erase(symbol);
+
     // Process all the new features
     // Note: Items will be added to unprocessed_features during processing
-    feature_list_t temp_feature_list = std::move(unprocessed_features);
+    auto temp_feature_list = std::move(unprocessed_features);
     for (auto f: temp_feature_list) {
       add_feature(f);
     }
@@ -666,40 +1105,50 @@ project::state project::evaluate_dependencies()
     // Check if we have finished but we've come across replaced components
     if (unprocessed_components.empty() && unprocessed_features.empty() && unprocessed_replacements.size() != 0) {
       // move new replacements
+      std::vector<c4::csubstr> replaced;
       for (auto &[replacement, id]: unprocessed_replacements) {
         spdlog::info("Adding {} to replaced_components", replacement);
         // replaced_components.insert(replacement);
         replacements.insert({ replacement, id });
+        replaced.push_back(replacement);
       }
       unprocessed_replacements.clear();
 
-      // Restart the whole process
-      required_features.clear();
-      required_components.clear();
-      unprocessed_choices.clear();
-      unprocessed_components.clear();
-      unprocessed_features.clear();
-      components.clear();
-      project_summary["components"].clear();
-
-      // Set the initial state
-      for (const auto &c: initial_components)
-        unprocessed_components.insert(c);
-      for (const auto &f: initial_features)
-        unprocessed_features.insert(f);
-
-      spdlog::info("Start project processing again...");
+      // Remove the replaced components in place when nothing else merged data for them, otherwise restart
+      if (!retract_components(replaced)) {
+        // Keep every parsed component so the restart merges them again instead of parsing them
+        for (auto &c: components)
+          if (c->parsed_root.valid())
+            retained_components.insert({ symbols.intern(c->root.key()), std::move(c) });
+
+        // Restart the whole process
+        required_features.clear();
+        required_components.clear();
+        unprocessed_choices.clear();
+        unprocessed_components.clear();
+        unprocessed_features.clear();
+        components.clear();
+        component_supporters.clear();
+        feature_supporters.clear();
+        project_summary["components"].clear();
+
+        // Set the initial state
+        for (const auto &c: initial_components)
+          unprocessed_components.insert(c);
+        for (const auto &f: initial_features)
+          unprocessed_features.insert(f);
+
+        spdlog::info("Start project processing again...");
+      }
     }
 
     // Check if we have finished but we have unprovided features
     if (unprocessed_components.empty() && unprocessed_features.empty() && unprovided_features.size() != 0) {
       auto temp_list = std::move(unprovided_features);
+      temp_list -= provided_features;
 
       // Look for any recommendations
       for (const auto &f: temp_list) {
-        // Verify it hasn't been provided
-        if (provided_features.contains(f))
-          continue;
         if (feature_recommendations.contains(f)) {
           const auto &recommendation = feature_recommendations[f];
           if (recommendation.contains("component")) {
@@ -721,10 +1170,8 @@ project::state project::evaluate_dependencies()
     if (unprocessed_components.empty() && unprocessed_features.empty() && component_flags != component_database::flag::IGNORE_ALL_SLC) {
       // Find any features that aren't provided
       auto temp_require_list = std::move(slc_required);
+      temp_require_list -= slc_provided;
       for (const auto &r: temp_require_list) {
-        if (slc_provided.contains(r))
-          continue;
-
         // Check the databases
         auto f = workspace.find_feature(r);
         if (!f.has_value()) {
@@ -739,14 +1186,14 @@ project::state project::evaluate_dependencies()
         // Go through possible options
         for (const auto &option: feature_node) {
           // Ignore if it is excluded
-          if (option.is_map() && (!condition_is_fulfilled(option) || is_disqualified_by_unless(option)))
+          if (option.is_map() && !is_active(option))
             continue;
 
           const auto name = option.is_map() ? option["name"].val() : option.val();
 
           // If this is recommended add to the recommended list, otherwise add to other options list
           if (slc_recommended.contains(name)) {
-            if (condition_is_fulfilled(slc_recommended[name]) && !is_disqualified_by_unless(slc_recommended[name]))
+            if (is_active(slc_recommended[name]))
               recommended_options.insert(name);
           } else {
             other_options.insert(name);
@@ -785,10 +1232,8 @@ project::state project::evaluate_dependencies()
     // Final check to see if Yakka component can provide an SLC requirement
     if (unprocessed_components.empty() && unprocessed_features.empty() && !slc_required.empty() && component_flags != component_database::flag::IGNORE_ALL_SLC) {
       auto temp_require_list = std::move(slc_required);
+      temp_require_list -= slc_provided;
       for (const auto &r: temp_require_list) {
-        if (slc_provided.contains(r))
-          continue;
-
         // Try find a component with a matching name
         auto component_location = workspace.find_component(r, component_flags);
         if (component_location.has_value()) {
@@ -805,6 +1250,8 @@ project::state project::evaluate_dependencies()
       break;
   }
 
+  release_parsed_trees();
+
   for (const auto &r: slc_required) {
     auto f = workspace.find_feature(r);
     if (f.has_value()) {
@@ -887,7 +1334,7 @@ void project::generate_project_summary()
   project_summary["project_file"] << project_file.string();
   project_summary["project_output"] << default_output_directory + project_name;
   // project_summary["configuration"]  << workspace.summary["configuration"];
-  workspace.summary["configuration"].duplicate(project_summary, project_summary.last_child());
+  ryml_append_copy(project_summary, workspace.summary["configuration"]);
 
   // TODO: Implement ryml version - needs json::object()
   if (!project_summary.contains("tools"))
@@ -920,7 +1367,7 @@ void project::generate_project_summary()
   }
 
   // project_summary["features"] |= ryml::SEQ;
-  for (auto &i: this->required_features)
+  for (const auto i: this->required_features)
     project_summary["features"].append_child() << i;
 
   project_summary["initial"] |= ryml::MAP;
@@ -965,6 +1412,10 @@ void project::generate_target_database()
   std::unordered_set<ryml::csubstr> processed_targets;
   std::vector<ryml::csubstr> unprocessed_targets;
 
+  const auto dependency_log_path = output_path / yakka::dependency_log_filename;
+  if (fs::exists(dependency_log_path) && !blueprint_database.dependency_log.load(dependency_log_path))
+    spdlog::info("Ignoring unreadable dependency log {}", dependency_log_path.generic_string());
+
   for (const auto &c: commands)
     unprocessed_targets.push_back(c);
 
@@ -999,6 +1450,324 @@ void project::generate_target_database()
     unprocessed_targets.clear();
     unprocessed_targets.swap(new_targets);
   }
+
+  if (!fs::exists(output_path))
+    return;
+  if (blueprint_database.dependency_log.is_dirty())
+    blueprint_database.dependency_log.save(dependency_log_path);
+}
+
+/// @brief Executes log_arena_usage.
+
+void project::log_arena_usage() const
+{
+  // The arenas never shrink so the totals are the high-water marks for this run
+  spdlog::debug("Project data arena: {} of {} bytes in {} chunk(s)", project_data.arena_total_size(), project_data.arena_total_capacity(), project_data.arena_num_chunks());
+  spdlog::debug("Blueprint database arena: {} of {} bytes in {} chunk(s)", blueprint_database.database.arena_total_size(), blueprint_database.database.arena_total_capacity(), blueprint_database.database.arena_num_chunks());
+}
+
+/// @brief Executes hash_summaries.
+
+// Precompute the structural hash of every node in the previous and current summaries so data
+// dependency checks compare two integers instead of serialising subtrees. Each component is hashed
+// as an independent task; the summary roots are then combined from the cached child hashes. Every
+// node is hashed here so data dependency tasks only ever read the table.
+void project::hash_summaries(tf::Executor &executor)
+{
+  summary_hashes.assign(project_data.capacity(), 0);
+
+  std::vector<ryml::ConstNodeRef> subtrees;
+  // A restored evaluation uses the same node for both summaries
+  std::vector<ryml::ConstNodeRef> summaries{ previous_summary };
+  if (project_summary != previous_summary)
+    summaries.push_back(project_summary);
+
+  for (const auto summary: summaries) {
+    if (!summary.valid())
+      continue;
+    for (const auto child: summary.children()) {
+      if (child.has_key() && child.key() == "components" && child.is_map())
+        for (const auto c: child.children())
+          subtrees.push_back(c);
+      else
+        subtrees.push_back(child);
+    }
+  }
+
+  tf::Taskflow taskflow;
+  taskflow.for_each(subtrees.begin(), subtrees.end(), [&](ryml::ConstNodeRef node) {
+    hash_node(node, summary_hashes);
+  });
+  executor.run(taskflow).wait();
+
+  if (previous_summary.valid())
+    hash_node(previous_summary, summary_hashes);
+  if (project_summary.valid())
+    hash_node(project_summary, summary_hashes);
+}
+
+/// @brief Executes find_template_identifiers.
+
+// Collects the root-level data names read by the `{{ }}` and `{% %}` blocks of a Jinja template.
+// Only the first segment of a variable path counts. Member names, function, filter and test names
+// and names bound by an enclosing `for` or an earlier `set` are skipped.
+static std::set<std::string> find_template_identifiers(std::string_view text)
+{
+  std::set<std::string> identifiers;
+  std::vector<std::set<std::string, std::less<>>> loop_scopes;
+  std::set<std::string, std::less<>> set_names;
+  const auto is_identifier = [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  };
+  const auto is_bound = [&](std::string_view name) {
+    return set_names.contains(name) || std::ranges::any_of(loop_scopes, [&](const auto &scope) {
+             return scope.contains(name);
+           });
+  };
+
+  // Template keywords never name a contribution
+  static const std::set<std::string_view> keywords{ "and", "block", "elif", "else", "endblock", "endfor", "endif", "extends", "false", "for", "if", "in", "include", "is", "loop", "none", "not", "or", "set", "true" };
+
+  size_t position = 0;
+  std::vector<std::string_view> tokens;
+  while ((position = text.find('{', position)) != std::string_view::npos) {
+    if (position + 1 >= text.size() || (text[position + 1] != '{' && text[position + 1] != '%')) {
+      ++position;
+      continue;
+    }
+    const bool is_statement = text[position + 1] == '%';
+    const auto end          = text.find(is_statement ? "%}" : "}}", position + 2);
+    const auto block        = text.substr(position + 2, end == std::string_view::npos ? std::string_view::npos : end - position - 2);
+
+    // Split the block into identifiers, string literals and single punctuation characters
+    tokens.clear();
+    for (size_t i = 0; i < block.size();) {
+      const char c       = block[i];
+      const size_t start = i;
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        ++i;
+        continue;
+      }
+      if (c == '"' || c == '\'') {
+        const auto close = block.find(c, i + 1);
+        i                = close == std::string_view::npos ? block.size() : close + 1;
+      } else if (is_identifier(c)) {
+        while (i < block.size() && is_identifier(block[i]))
+          ++i;
+      } else {
+        ++i;
+      }
+      tokens.push_back(block.substr(start, i - start));
+    }
+
+    // Find the names a statement binds. They apply after the statement, so `for x in x` still reads x.
+    size_t first = 0;
+    std::set<std::string, std::less<>> bound;
+    const auto keyword = is_statement && !tokens.empty() ? tokens.front() : std::string_view{};
+    if (keyword == "for") {
+      for (first = 1; first < tokens.size() && tokens[first] != "in"; ++first)
+        if (is_identifier(tokens[first].front()))
+          bound.emplace(tokens[first]);
+    } else if (keyword == "set" && tokens.size() > 1) {
+      bound.emplace(tokens[1]);
+      for (first = 1; first < tokens.size() && tokens[first] != "="; ++first)
+        ;
+    } else if (keyword == "endfor" && !loop_scopes.empty()) {
+      loop_scopes.pop_back();
+    }
+
+    for (size_t n = first; n < tokens.size(); ++n) {
+      const auto token = tokens[n];
+      if (!is_identifier(token.front()) || std::isdigit(static_cast<unsigned char>(token.front())) || keywords.contains(token))
+        continue;
+      const auto previous = n > 0 ? tokens[n - 1] : std::string_view{};
+      if (previous == "." || previous == "|" || previous == "is" || (previous == "not" && n > 1 && tokens[n - 2] == "is"))
+        continue;
+      if (n + 1 < tokens.size() && tokens[n + 1] == "(")
+        continue;
+      if (!is_bound(token))
+        identifiers.emplace(token);
+    }
+
+    if (keyword == "for")
+      loop_scopes.push_back(std::move(bound));
+    else if (keyword == "set")
+      set_names.merge(bound);
+
+    if (end == std::string_view::npos)
+      break;
+    position = end + 2;
+  }
+
+  return identifiers;
+}
+
+namespace {
+struct fingerprint_entry {
+  std::string digest;
+  int64_t time;
+  uintmax_t size;
+};
+
+struct evaluation_fingerprint {
+  std::string inputs;
+  std::map<std::string, fingerprint_entry> files;
+};
+
+constexpr std::string_view fingerprint_signature = "# yakka fingerprint 1";
+
+/// @brief Executes load_fingerprint.
+
+// Reads a fingerprint: the signature, the digest of the command line inputs and then a
+// `digest time size path` line per input file
+std::optional<evaluation_fingerprint> load_fingerprint(const fs::path &filename)
+{
+  std::ifstream file(filename);
+  std::string line;
+  if (!std::getline(file, line) || line != fingerprint_signature)
+    return std::nullopt;
+
+  evaluation_fingerprint fingerprint;
+  if (!std::getline(file, line) || !line.starts_with("inputs "))
+    return std::nullopt;
+  fingerprint.inputs = line.substr(7);
+
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    fingerprint_entry entry;
+    std::string path;
+    if (!(fields >> entry.digest >> entry.time >> entry.size) || !std::getline(fields >> std::ws, path))
+      return std::nullopt;
+    fingerprint.files.emplace(std::move(path), std::move(entry));
+  }
+  return fingerprint;
+}
+} // namespace
+
+/// @brief Executes evaluation_input_files.
+
+// Every file whose content feeds the evaluation: the parsed components, the project file, the component
+// databases and any other file read while evaluating, such as SLC template files
+std::vector<fs::path> project::evaluation_input_files() const
+{
+  std::vector<fs::path> files(evaluation_reads.begin(), evaluation_reads.end());
+  for (const auto &c: components)
+    if (!c->file_path.empty())
+      files.push_back(c->file_path);
+  if (fs::exists(project_file))
+    files.push_back(project_file);
+  for (const auto *db: { &workspace.local_database, &workspace.shared_database })
+    if (!db->get_path().empty())
+      files.push_back(db->get_path() / yakka::database_filename);
+  for (const auto &db: workspace.package_databases)
+    files.push_back(db.get_path() / yakka::database_filename);
+
+  std::ranges::sort(files);
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
+
+/// @brief Executes save_evaluation_fingerprint.
+
+void project::save_evaluation_fingerprint(const std::string &inputs)
+{
+  // The component databases are fingerprinted through their files, so index changes made while
+  // evaluating, such as SLCE component paths scanned into the local database, are saved first
+  for (const auto *db: { &workspace.local_database, &workspace.shared_database })
+    if (db->is_dirty() && !db->get_path().empty())
+      if (auto result = db->save(); !result)
+        spdlog::error("Failed to save database: {}", result.error().message());
+
+  // Digests of files whose timestamp and size are unchanged are carried over rather than recomputed
+  const auto previous = load_fingerprint(output_path / yakka::fingerprint_filename);
+
+  std::string fingerprint = std::string{ fingerprint_signature } + "\ninputs " + content_digest(inputs) + "\n";
+  for (const auto &file: evaluation_input_files()) {
+    std::error_code ec;
+    const auto time = fs::last_write_time(file, ec).time_since_epoch().count();
+    const auto size = ec ? 0 : fs::file_size(file, ec);
+    if (ec)
+      continue;
+
+    const auto path = file.generic_string();
+    std::string digest;
+    if (previous) {
+      const auto it = previous->files.find(path);
+      if (it != previous->files.end() && it->second.time == time && it->second.size == size)
+        digest = it->second.digest;
+    }
+    if (digest.empty())
+      digest = file_digest(file);
+    fingerprint += std::format("{} {} {} {}\n", digest, time, size, path);
+  }
+  save_file_if_changed(output_path / yakka::fingerprint_filename, fingerprint);
+}
+
+/// @brief Executes restore_evaluation.
+
+// Reuses the summary from the previous run when the command line and every input file are unchanged.
+// Files are compared by timestamp and size, falling back to their digest when those differ.
+bool project::restore_evaluation(const std::string &inputs)
+{
+  if (!cached_summary.valid() || !cached_summary.is_map() || !cached_summary.has_child("components"))
+    return false;
+  if (fs::exists(output_path / contributions_filename) && !fs::exists(output_path / contribution_sources_filename))
+    return false;
+
+  const auto fingerprint = load_fingerprint(output_path / yakka::fingerprint_filename);
+  if (!fingerprint || fingerprint->files.empty() || fingerprint->inputs != content_digest(inputs))
+    return false;
+
+  for (const auto &[path, entry]: fingerprint->files) {
+    std::error_code ec;
+    const auto time = fs::last_write_time(path, ec).time_since_epoch().count();
+    const auto size = ec ? 0 : fs::file_size(path, ec);
+    if (ec)
+      return false;
+    if ((time != entry.time || size != entry.size) && file_digest(path) != entry.digest)
+      return false;
+  }
+
+  // With unchanged inputs the previous summary is also the current one, so data dependencies are unchanged
+  project_summary  = cached_summary;
+  previous_summary = cached_summary;
+
+  required_features.clear();
+  for (const auto &f: project_summary["features"])
+    if (f.has_val())
+      required_features.insert(f.val());
+
+  components.clear();
+  required_components.clear();
+  for (auto node: project_summary["components"].children()) {
+    auto c  = std::make_shared<yakka::component>();
+    c->root = node;
+    if (node.has_child("yakka_file"))
+      c->file_path = ryml_path(node["yakka_file"].val());
+    if (node.has_child("id"))
+      c->restore_metadata();
+    else
+      c->id = node.key();
+    required_components.insert(c->id);
+    components.push_back(c);
+  }
+
+  // The template contributions were saved as process_slc_rules() leaves them, gathered with the sorted form as a child
+  contribution_sources.clear_children();
+  template_contributions = contribution_sources;
+  if (auto sources = get_file_contents<std::string>(output_path / contribution_sources_filename); sources && !sources->empty()) {
+    ryml::parse_in_arena(ryml::to_csubstr(*sources), contribution_sources);
+    if (contribution_sources.has_child("sorted"))
+      template_contributions = contribution_sources["sorted"];
+  }
+
+  // Every shard is a name that was contributed or read by a template
+  referenced_contributions.clear();
+  std::error_code ec;
+  for (const auto &entry: fs::directory_iterator(output_path / contributions_directory, ec))
+    if (entry.path().extension() == ".yaml")
+      referenced_contributions.insert(entry.path().stem().string());
+  return true;
 }
 
 /**
@@ -1014,38 +1783,70 @@ void project::save_summary()
   const fs::path project_summary_path = ryml_path(project_summary["project_output"].val()) / yakka::project_summary_filename;
   ryml_save_file(project_summary_path, project_summary);
 
-  const fs::path template_contribution_filename = ryml_path(project_summary["project_output"].val()) / "template_contributions.json";
+  // update_summary() compares component files against the time of the summary. An unchanged summary
+  // is not rewritten, so its time is set here to mark it as current.
+  {
+    std::error_code ec;
+    fs::last_write_time(project_summary_path, fs::file_time_type::clock::now(), ec);
+  }
+  const fs::path snapshot_path = ryml_path(project_summary["project_output"].val()) / yakka::project_snapshot_filename;
+  save_file_if_changed(snapshot_path, ryml_snapshot(project_summary));
 
-  // Check if template contribution file exists
-  if (fs::exists(template_contribution_filename)) {
-    // Read the content and compare to the current value, only rewrite if content is different
-    auto existing_template_contribution = ryml_load_file(template_contribution_filename);
-    if (!existing_template_contribution.has_value()) {
-      spdlog::error("Failed to parse existing template contribution file '{}'", template_contribution_filename.generic_string());
-    } else {
-      // TODO: Implement ryml diffing and patching to preserve comments and formatting - needs ryml::Tree::diff() and patch application
-      // auto patch = ryml::Tree::diff(template_contributions, *existing_template_contribution);
-      // if (patch.size() == 0) {
-      //   return;
-      // }
+  // An unchanged snapshot is not rewritten, so mark it current if the YAML was written after it
+  if (!is_up_to_date(snapshot_path, project_summary_path)) {
+    std::error_code ec;
+    fs::last_write_time(snapshot_path, fs::file_time_type::clock::now(), ec);
+  }
+
+  // Save the combined contributions used to render templates, plus one shard per contribution name
+  // which generated files depend on. A name a template reads but no component contributes gets an
+  // empty shard, so adding or removing its last contribution changes the shard and rebuilds the file.
+  const fs::path output_path     = ryml_path(project_summary["project_output"].val());
+  const fs::path shard_directory = output_path / contributions_directory;
+  std::set<std::string> shard_names;
+  if (!template_contributions.empty() || !referenced_contributions.empty()) {
+    if (!template_contributions.empty()) {
+      ryml_save_file(output_path / contributions_filename, template_contributions);
+      ryml_save_file(output_path / contribution_sources_filename, contribution_sources);
     }
-  } else {
-    // Create the template contributions file
-    if (!template_contributions.empty())
-      ryml_save_file(template_contribution_filename, template_contributions);
+
+    fs::create_directories(shard_directory);
+    for (const auto contribution: template_contributions.children()) {
+      const auto name = ryml_string(contribution.key());
+      save_file_if_changed(shard_directory / (name + ".yaml"), ryml::emitrs_yaml<std::string>(contribution));
+      shard_names.insert(name + ".yaml");
+    }
+    for (const auto &name: referenced_contributions)
+      if (shard_names.insert(name + ".yaml").second)
+        save_file_if_changed(shard_directory / (name + ".yaml"), name + ": []\n");
   }
+
+  // Remove shards of contributions that are no longer produced
+  std::error_code ec;
+  for (const auto &entry: fs::directory_iterator(shard_directory, ec))
+    if (!shard_names.contains(entry.path().filename().string()))
+      fs::remove(entry.path(), ec);
 }
 
 /// @brief Executes validate_schema.
 
 void project::validate_schema()
 {
-  // Verify schema for each component
-
-  for (const auto &c: components) {
-    if (project_schema.validate(c->root, c->id) == false)
-      current_state = state::PROJECT_HAS_FAILED_SCHEMA_CHECK;
+  // Verify schema for each component, in parallel as validation only reads the summary
+
+  std::vector<char> valid(components.size(), true);
+  const auto validate_component = [&](size_t n) {
+    valid[n] = project_schema.validate(components[n]->root, components[n]->id);
+  };
+  if (components.size() > 1) {
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(size_t{ 0 }, components.size(), size_t{ 1 }, validate_component);
+    get_executor().run(taskflow).wait();
+  } else if (components.size() == 1) {
+    validate_component(0);
   }
+  if (std::ranges::find(valid, false) != valid.end())
+    current_state = state::PROJECT_HAS_FAILED_SCHEMA_CHECK;
 
   // Verify data schema for the project
   if (data_schema.validate(project_summary["data"], "project_data") == false)
@@ -1058,39 +1859,60 @@ void project::validate_schema()
 void project::update_project_data()
 
 {
-  std::unordered_set<ryml::csubstr> required_data;
+  // Pointers own their path strings, and a deque keeps them in place as more are added
+  std::deque<ryml::Pointer> pointers;
+  std::unordered_set<std::string_view> seen;
 
   // Gather all the required data
   for (const auto &c: components)
     if (c->root.contains(ryml::Pointer("/requires/data")))
-      for (const auto &d: c->root.at(ryml::Pointer("/requires/data"))) {
-        required_data.insert(d.val());
-      }
+      for (const auto &d: c->root.at(ryml::Pointer("/requires/data")))
+        if (seen.insert(std::string_view{ d.val().str, d.val().len }).second)
+          pointers.emplace_back(std::string_view{ d.val().str, d.val().len });
+
+  // Index which components hold each top-level key that is required
+  std::unordered_map<ryml::csubstr, std::vector<size_t>> holders;
+  for (const auto &p: pointers)
+    if (!p.empty())
+      holders.insert({ p.front(), {} });
+
+  for (size_t i = 0; i < components.size(); ++i)
+    for (const auto &child: components[i]->root.children()) {
+      auto it = holders.find(child.key());
+      if (it != holders.end())
+        it->second.push_back(i);
+    }
 
-  // Merge all the component data into the project summary
-  for (const auto &c: components) {
-    for (const auto &r: required_data) {
-      const auto pointer = ryml::Pointer(r);
-      if (!c->root.contains(pointer)) {
+  // Merge each pointer from only the components that can hold it
+  for (const auto &pointer: pointers) {
+    if (pointer.empty())
+      continue;
+
+    ryml::NodeRef data_node;
+    for (const auto i: holders[pointer.front()]) {
+      const auto &c = components[i];
+      if (!c->root.contains(pointer))
         continue;
-      }
       auto component_node = c->root.at(pointer);
 
-      if (!project_summary["data"].contains(pointer)) {
+      if (!data_node.valid()) {
+        auto target = project_summary["data"][pointer];
+        if (!target.valid()) {
+          spdlog::error("Cannot add '{}' from {} to the project data", pointer.to_string(), c->id);
+          break;
+        }
         if (component_node.is_seq())
-          project_summary["data"][pointer] |= ryml::SEQ;
+          target |= ryml::SEQ;
         else if (component_node.is_map())
-          project_summary["data"][pointer] |= ryml::MAP;
+          target |= ryml::MAP;
         else
-          project_summary["data"][pointer] |= ryml::VAL;
+          target |= ryml::VAL;
+        data_node = project_summary["data"].at(pointer);
       }
 
-      // json_node_merge(pointer, project_summary["data"][pointer], c->root[pointer], &data_schema);
-      merge_nodes(project_summary["data"].at(pointer), component_node);
-
-      auto test_node = project_summary["data"].at(pointer);
-      if (!test_node.is_seq() && !test_node.is_map() && !test_node.has_val()) {
-        spdlog::error("BAD");
+      if (!data_schema.merge(data_node, component_node, pointer)) {
+        spdlog::error("Failed to merge '{}' from {}", pointer.to_string(), c->id);
+        current_state = state::PROJECT_HAS_FAILED_SCHEMA_CHECK;
       }
     }
   }
@@ -1124,6 +1946,29 @@ bool project::condition_is_fulfilled(ryml::ConstNodeRef node)
   return true;
 }
 
+/// @brief Executes is_active.
+
+// Equivalent to `condition_is_fulfilled(node) && !is_disqualified_by_unless(node)` with a single scan of the keys
+bool project::is_active(ryml::ConstNodeRef node)
+{
+  if (!node.is_map())
+    return true;
+
+  for (const auto child: node.children()) {
+    const auto key = child.key();
+    if (key == "condition") {
+      for (const auto &condition: child)
+        if (!required_features.contains(condition.val()))
+          return false;
+    } else if (key == "unless") {
+      for (const auto &u: child)
+        if (required_features.contains(u.val()))
+          return false;
+    }
+  }
+  return true;
+}
+
 /// @brief Executes create_config_file.
 
 void project::create_config_file(const std::shared_ptr<yakka::component> component, ryml::ConstNodeRef config, const std::string &prefix, std::string instance_name)
@@ -1140,7 +1985,7 @@ void project::create_config_file(const std::shared_ptr<yakka::component> compone
       for (auto c = overriding_components.first; c != overriding_components.second; ++c) {
         // Find the matching config, check conditions, and matching instance.
         for (const auto &i: c->second->root["config_file"]) {
-          if (i.contains("override") && i["override"]["file_id"].val() == file_id && !is_disqualified_by_unless(i) && condition_is_fulfilled(i)) {
+          if (i.contains("override") && i["override"]["file_id"].val() == file_id && is_active(i)) {
             if (i["override"].contains("instance") && i["override"]["instance"].val() == instance_name) {
               config_file_path = c->second->component_path / i["path"].val<std::string>().value();
               break;
@@ -1156,10 +2001,10 @@ void project::create_config_file(const std::shared_ptr<yakka::component> compone
 
   ryml::Tree temp_tree;
   temp_tree["instance"] << prefix;
-  config_file_path = this->inja_environment.render(config_file_path.generic_string(), temp_tree.rootref());
+  config_file_path = render_cached(this->inja_environment, config_file_path.generic_string(), temp_tree.rootref());
 
   temp_tree["instance"] << instance_name;
-  std::filesystem::path destination_path = std::filesystem::path{ default_output_directory + project_name + "/config" } / this->inja_environment.render(std::filesystem::path(config_filename).filename().string(), temp_tree.rootref());
+  std::filesystem::path destination_path = std::filesystem::path{ default_output_directory + project_name + "/config" } / render_cached(this->inja_environment, std::filesystem::path(config_filename).filename().string(), temp_tree.rootref());
   if (!instance_name.empty()) {
     // Convert instance name uppercase
     std::transform(instance_name.begin(), instance_name.end(), instance_name.begin(), ::toupper);
@@ -1177,7 +2022,6 @@ void project::create_config_file(const std::shared_ptr<yakka::component> compone
   blueprint["depends"] |= ryml::SEQ;
   blueprint["process"] |= ryml::SEQ;
   blueprint["depends"].append_child() << config_file_path.string();
-  blueprint["depends"].append_child() << "{{project_output}}/template_contributions.json";
   auto process_node = blueprint["process"].append_child();
   process_node |= ryml::MAP;
   process_node["inja"] << "{% set input = read_file(\"" + config_file_path.string() + "\" )%}{{replace(input, \"\\bINSTANCE\\b\", \"" + instance_name + "\")}}";
@@ -1192,6 +2036,21 @@ void project::create_config_file(const std::shared_ptr<yakka::component> compone
 
 void project::process_slc_rules()
 {
+  // Template blueprints and their template files, whose contribution dependencies are added once all contributions are known
+  std::vector<std::pair<ryml::NodeRef, std::string>> template_blueprints;
+
+  // SLC items of each component, bucketed by category in a single pass over its keys
+  struct slc_categories {
+    ryml::NodeRef source;
+    ryml::NodeRef include;
+    ryml::NodeRef define;
+    ryml::NodeRef library;
+    ryml::NodeRef template_contribution;
+    ryml::NodeRef config_file;
+    ryml::NodeRef template_file;
+    ryml::NodeRef toolchain_settings;
+  };
+
   // Go through each SLC based component
 
   // std::vector<std::shared_ptr<yakka::component>>::size_type size = components.size();
@@ -1206,39 +2065,74 @@ void project::process_slc_rules()
 
     // Process SLCE files and add every component found in the component paths
     if (c->type == component::SLCE_FILE) {
-      std::unordered_set<std::filesystem::path> added_components;
-      // Find all .slcc files in the component paths and add them
+      // Resolve the .slcc files through the component databases. A path with no indexed files is scanned
+      // into the local database once, instead of walking the directory on every evaluation.
+      std::vector<std::filesystem::path> component_files;
       for (const auto &p: c->root["component_path"]) {
-        for (const auto &component_path: glob::rglob(p["path"].val<std::string>().value() + "/**/*.slcc")) {
-          // Only add component if it hasn't been seen before
-          if (added_components.insert(component_path).second == true) {
-            std::shared_ptr<yakka::component> new_component = std::make_shared<yakka::component>();
-            auto new_component_node                         = project_summary["components"].append_child() << ryml::Key("__temp__");
-            new_component_node |= ryml::MAP;
-            if (new_component->parse_file(component_path, "", new_component_node) == yakka::yakka_status::SUCCESS) {
-              components.push_back(new_component);
-              // Set the key to the ID
-              new_component_node << ryml::key(new_component->id);
-
-              // ++size;
-              // Process all the required components
-              if (new_component->root.contains("requires") && new_component->root["requires"].contains("features"))
-                for (const auto &r: new_component->root["requires"]["features"])
-                  slc_required.insert(r.val());
-            }
-          }
+        const std::filesystem::path search_path = p["path"].val<std::string>().value();
+        auto files                              = workspace.find_component_files(search_path, slcc_component_extension);
+        if (files.empty()) {
+          workspace.local_database.scan_for_components(search_path);
+          files = workspace.find_component_files(search_path, slcc_component_extension);
         }
+        component_files.insert(component_files.end(), files.begin(), files.end());
+      }
+      std::ranges::sort(component_files);
+      component_files.erase(std::unique(component_files.begin(), component_files.end()), component_files.end());
+
+      // Parse each file into its own tree in parallel
+      std::vector<std::shared_ptr<yakka::component>> parsed_components(component_files.size());
+      tf::Taskflow taskflow;
+      taskflow.for_each_index(size_t{ 0 }, component_files.size(), size_t{ 1 }, [&](size_t n) {
+        auto new_component = std::make_shared<yakka::component>();
+        if (new_component->parse_file(component_files[n]) == yakka::yakka_status::SUCCESS)
+          parsed_components[n] = new_component;
+      });
+      get_executor().run(taskflow).wait();
+
+      // Merge into the project summary in path order so the result does not depend on scheduling
+      for (auto &new_component: parsed_components) {
+        if (!new_component)
+          continue;
+
+        merge_component(new_component->id, new_component);
+        components.push_back(new_component);
+        index_supports(components.size() - 1, new_component->root);
+
+        // Process all the required components
+        if (new_component->root.contains("requires") && new_component->root["requires"].contains("features"))
+          for (const auto &r: new_component->root["requires"]["features"])
+            slc_required.insert(r.val());
       }
       evaluate_dependencies();
       continue;
     }
 
+    slc_categories categories;
+    for (auto child: c->root.children()) {
+      const auto key = child.key();
+      if (key == "source")
+        categories.source = child;
+      else if (key == "include")
+        categories.include = child;
+      else if (key == "define")
+        categories.define = child;
+      else if (key == "library")
+        categories.library = child;
+      else if (key == "template_contribution")
+        categories.template_contribution = child;
+      else if (key == "config_file")
+        categories.config_file = child;
+      else if (key == "template_file")
+        categories.template_file = child;
+      else if (key == "toolchain_settings")
+        categories.toolchain_settings = child;
+    }
+
     // Process sources
-    if (c->root.contains("source")) {
-      for (const auto &p: c->root["source"]) {
-        if (!p.contains("path"))
-          continue;
-        if (is_disqualified_by_unless(p) || !condition_is_fulfilled(p))
+    if (categories.source.valid()) {
+      for (const auto &p: categories.source) {
+        if (!p.contains("path") || !is_active(p))
           continue;
 
         std::filesystem::path source_path{ p["path"].val<std::string>().value() };
@@ -1248,9 +2142,9 @@ void project::process_slc_rules()
     }
 
     // Process 'include'
-    if (c->root.contains("include")) {
-      for (const auto &p: c->root["include"]) {
-        if (is_disqualified_by_unless(p) || !condition_is_fulfilled(p))
+    if (categories.include.valid()) {
+      for (const auto &p: categories.include) {
+        if (!is_active(p))
           continue;
 
         c->root["includes"]["global"].append_child() << p["path"].val();
@@ -1258,9 +2152,9 @@ void project::process_slc_rules()
     }
 
     // Process 'define'
-    if (c->root.contains("define")) {
-      for (auto p: c->root["define"]) {
-        if (is_disqualified_by_unless(p) || !condition_is_fulfilled(p))
+    if (categories.define.valid()) {
+      for (auto p: categories.define) {
+        if (!is_active(p))
           continue;
 
         // TODO: Implement ryml version - needs ternary operator with ryml nodes
@@ -1269,9 +2163,9 @@ void project::process_slc_rules()
           ryml::Tree temp_tree;
           temp_tree["instance"] << instance_prefix;
           if (temp.has_child("value"))
-            temp["name"] << this->inja_environment.render(temp["name"].val<std::string>().value(), temp_tree.rootref());
+            temp["name"] << render_cached(this->inja_environment, temp["name"].val<std::string>().value(), temp_tree.rootref());
           else
-            temp << this->inja_environment.render(temp.val<std::string>().value(), temp_tree.rootref());
+            temp << render_cached(this->inja_environment, temp.val<std::string>().value(), temp_tree.rootref());
         }
         temp.duplicate(c->root["defines"]["global"].last_child());
         // c->root["defines"]["global"].append_child() << temp;
@@ -1279,22 +2173,19 @@ void project::process_slc_rules()
     }
 
     // Process library
-    if (c->root.contains("library")) {
-      for (auto p: c->root["library"]) {
-        if (!p.contains("path"))
-          continue;
-        if (is_disqualified_by_unless(p) || !condition_is_fulfilled(p))
+    if (categories.library.valid()) {
+      for (auto p: categories.library) {
+        if (!p.contains("path") || !is_active(p))
           continue;
 
-        std::filesystem::path source_path{ p["path"].val<std::string>().value() };
         c->root["libraries"].append_child() << p["path"].val();
       }
     }
 
     // Process template_contributions
-    if (c->root.contains("template_contribution")) {
-      for (auto t: c->root["template_contribution"]) {
-        if (is_disqualified_by_unless(t) || !condition_is_fulfilled(t))
+    if (categories.template_contribution.valid()) {
+      for (auto t: categories.template_contribution) {
+        if (!is_active(t))
           continue;
 
         const auto name = t["name"].val();
@@ -1306,7 +2197,7 @@ void project::process_slc_rules()
               temp_tree["instance"] << i->second;
               auto new_node = t.duplicate(template_contributions[name], template_contributions[name].last_child());
               // auto new_node = template_contributions[name].append_child() << t;
-              new_node["value"] << this->inja_environment.render(t["value"].val<std::string>().value(), temp_tree.rootref());
+              new_node["value"] << render_cached(this->inja_environment, t["value"].val<std::string>().value(), temp_tree.rootref());
             }
           } else if (t["value"].is_map()) {
             for (auto i = instance_names.first; i != instance_names.second; ++i) {
@@ -1315,7 +2206,7 @@ void project::process_slc_rules()
               auto new_node = t.duplicate(template_contributions[name], template_contributions[name].last_child());
               for (auto child: new_node["value"].children()) {
                 if (child.has_val())
-                  new_node["value"][child.key()] << this->inja_environment.render(child.val<std::string>().value(), temp_tree.rootref());
+                  new_node["value"][child.key()] << render_cached(this->inja_environment, child.val<std::string>().value(), temp_tree.rootref());
               }
             }
           } else {
@@ -1330,11 +2221,11 @@ void project::process_slc_rules()
     }
 
     // Process config_file
-    if (c->root.contains("config_file")) {
-      for (auto config: c->root["config_file"]) {
+    if (categories.config_file.valid()) {
+      for (auto config: categories.config_file) {
         if (!config.contains("path"))
           continue;
-        if (is_disqualified_by_unless(config) || !condition_is_fulfilled(config))
+        if (!is_active(config))
           continue;
         if (instantiable && instance_names.first == instance_names.second)
           continue;
@@ -1350,9 +2241,10 @@ void project::process_slc_rules()
       }
 
       // Process 'template_file'
-      if (c->root.contains("template_file")) {
-        for (auto t: c->root["template_file"]) {
-          if (is_disqualified_by_unless(t) || !condition_is_fulfilled(t))
+      if (categories.template_file.valid()) {
+        const auto directory = c->root["directory"].val<std::string>().value();
+        for (auto t: categories.template_file) {
+          if (!is_active(t))
             continue;
 
           std::filesystem::path template_file = t["path"].val<std::string>().value();
@@ -1375,20 +2267,18 @@ void project::process_slc_rules()
           blueprint |= ryml::MAP;
           blueprint["depends"] |= ryml::SEQ;
           blueprint["process"] |= ryml::SEQ;
-          blueprint["depends"].append_child() << c->root["directory"].val<std::string>().value() + "/" + template_file.string();
-          blueprint["depends"].append_child() << "{{project_output}}/template_contributions.json";
-          blueprint["process"].append_child() << ryml::key("jinja") << "-t " + c->root["directory"].val<std::string>().value() + "/" + template_file.string() + " -d {{project_output}}/template_contributions.json";
+          blueprint["depends"].append_child() << directory + "/" + template_file.string();
+          template_blueprints.push_back({ blueprint, directory + "/" + template_file.string() });
+          blueprint["process"].append_child() << ryml::key("jinja") << "-t " + directory + "/" + template_file.string() + " -d {{project_output}}/" + contributions_filename;
           blueprint["process"].append_child() << ryml::key("save");
-
-          // c->root["blueprints"][target] = blueprint;
         }
       }
 
       // Process special toolchain settings
-      if (c->root.contains("toolchain_settings")) {
-        for (const auto &s: c->root["toolchain_settings"]) {
+      if (categories.toolchain_settings.valid()) {
+        for (const auto &s: categories.toolchain_settings) {
           if (s["option"] == "linkerfile") {
-            if (is_disqualified_by_unless(s) || !condition_is_fulfilled(s))
+            if (!is_active(s))
               continue;
 
             c->root["generated"]["linker_script"] << "{{project_output}}/generated/" + std::filesystem::path{ s["value"].val<std::string>().value() }.filename().string();
@@ -1396,58 +2286,82 @@ void project::process_slc_rules()
         }
       }
     }
+  }
 
-    // Process toolchain settings
-    project_summary["toolchain_settings"] |= ryml::MAP;
-    for (const auto &c: components) {
-      if (c->root.contains("toolchain_settings") == false)
-        continue;
+  // Process toolchain settings once every component has been added
+  auto toolchain_settings = project_summary["toolchain_settings"];
+  toolchain_settings |= ryml::MAP;
+  for (const auto &component: components) {
+    if (component->root.contains("toolchain_settings") == false)
+      continue;
 
-      for (const auto &s: c->root["toolchain_settings"]) {
-        if (is_disqualified_by_unless(s) || !condition_is_fulfilled(s))
-          continue;
+    for (const auto &s: component->root["toolchain_settings"]) {
+      if (!is_active(s))
+        continue;
 
-        const auto key = s["option"].val();
-        if (project_summary["toolchain_settings"].contains(key))
-          if (project_summary["toolchain_settings"][key].is_seq())
-            project_summary["toolchain_settings"][key].append_child() << s["value"].val();
-          else {
-            auto current_value = project_summary["toolchain_settings"][key].val();
-            project_summary["toolchain_settings"][key].set_type(ryml::SEQ);
-            project_summary["toolchain_settings"][key].append_child() << current_value;
-            project_summary["toolchain_settings"][key].append_child() << s["value"].val();
-          }
-        else
-          project_summary["toolchain_settings"][key] << s["value"].val();
+      const auto key = s["option"].val();
+      auto setting   = toolchain_settings.find_child(key);
+      if (!setting.valid())
+        toolchain_settings[key] << s["value"].val();
+      else if (setting.is_seq())
+        setting.append_child() << s["value"].val();
+      else {
+        auto current_value = setting.val();
+        setting.set_type(ryml::SEQ);
+        setting.append_child() << current_value;
+        setting.append_child() << s["value"].val();
       }
     }
   }
 
-  // Go through the template_contributions and sort via priorities
-  // TODO: Implement ryml version - local json variables for sorting
+  // Order each contribution by priority, keeping the declaration order of equal priorities
+  std::vector<ryml::NodeRef> contribution_groups;
+  for (auto item: template_contributions.children())
+    contribution_groups.push_back(item);
+
   ryml::NodeRef new_contributions = template_contributions.append_child() << ryml::key("sorted");
   new_contributions |= ryml::MAP;
-  for (auto item: template_contributions.children()) {
-    while (item.valid() && item.num_children() > 0) {
-      // Remove the item with the lowest priority
-      int lowest_priority       = INT_MAX;
-      int lowest_priority_index = 0;
-      for (size_t i = 0; i < item.num_children(); ++i) {
-        int priority = item[i].contains("priority") ? item[i]["priority"].val<int>().value() : 0;
-        if (priority < lowest_priority) {
-          lowest_priority       = priority;
-          lowest_priority_index = i;
-        }
-      }
-      auto entry = item[lowest_priority_index];
-      spdlog::info("Ordering '{}' at priority {}", entry["name"].val<std::string>().value(), lowest_priority);
-
-      //const std::string value = entry["value"].val();
-      new_contributions[entry["name"].val()].append_child() << entry["value"].val();
-      item.remove_child(lowest_priority_index);
+  std::vector<std::pair<int, ryml::NodeRef>> entries;
+  for (auto item: contribution_groups) {
+    entries.clear();
+    for (auto entry: item.children())
+      entries.push_back({ entry.contains("priority") ? entry["priority"].val<int>().value_or(0) : 0, entry });
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+      return a.first < b.first;
+    });
+    auto name = item.key();
+    spdlog::debug("Ordered {} '{}' contributions", entries.size(), name);
+
+    auto sorted = new_contributions.append_child() << ryml::key(name);
+    sorted |= ryml::SEQ;
+    for (auto &[priority, entry]: entries) {
+      if (!entry.contains("value"))
+        continue;
+      auto value = entry["value"];
+      if (value.has_val())
+        sorted.append_child() << value.val();
+      else
+        value.duplicate(sorted, sorted.last_child()).clear_key();
     }
   }
   template_contributions = new_contributions;
+
+  // Each generated file only depends on the contributions its template reads, whether or not any
+  // component contributes them yet
+  referenced_contributions.clear();
+  for (auto &[blueprint, template_path]: template_blueprints) {
+    evaluation_reads.insert(template_path);
+    auto template_text = get_file_contents<std::string>(template_path);
+    if (!template_text) {
+      spdlog::error("Failed to read template file '{}'", template_path);
+      blueprint["depends"].append_child() << "{{project_output}}/" + contributions_filename;
+      continue;
+    }
+    for (const auto &identifier: find_template_identifiers(template_text.value())) {
+      blueprint["depends"].append_child() << "{{project_output}}/" + contributions_directory + "/" + identifier + ".yaml";
+      referenced_contributions.insert(identifier);
+    }
+  }
 }
 
 /// @brief Executes process_blueprints.
@@ -7,6 +7,7 @@
 #include "target_database.hpp"
 #include "blueprint_database.hpp"
 #include "yakka_schema.hpp"
+#include "symbol_set.hpp"
 //#include "yaml-cpp/yaml.h"
 #include <ryml.hpp>
 #include <ryml_std.hpp>
@@ -18,9 +19,11 @@
 #include <filesystem>
 #include <regex>
 #include <map>
+#include <set>
 #include <unordered_set>
 #include <optional>
 #include <functional>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -40,6 +43,14 @@ public:
     PROJECT_VALID
   };
 
+  // Resolved location of a component that has not been added yet
+  struct component_location {
+    c4::csubstr id;
+    std::filesystem::path path;
+    std::filesystem::path package_path;
+    symbol_table::symbol_id symbol; // Interned `id`, so set membership is a bit test
+  };
+
 public:
   project(yakka::workspace &workspace, const std::string project_name = "");
 
@@ -56,6 +67,18 @@ public:
   state evaluate_dependencies();
   bool add_component(std::string &component_name, component_database::flag flags);
   bool add_component(c4::csubstr component_name, component_database::flag flags);
+  std::optional<component_location> resolve_component(c4::csubstr component_name, component_database::flag flags);
+  bool integrate_component(const component_location &location, std::shared_ptr<yakka::component> new_component);
+  void merge_component(c4::csubstr key, const std::shared_ptr<yakka::component> &new_component);
+  void index_supports(size_t position, ryml::ConstNodeRef node);
+  bool retract_components(const std::vector<c4::csubstr> &replaced);
+  void release_parsed_trees();
+  std::shared_ptr<yakka::component> take_retained_component(c4::csubstr component_id);
+  std::shared_ptr<yakka::component> take_retained_component(symbol_table::symbol_id symbol);
+  std::vector<std::shared_ptr<yakka::component>> parse_components(const std::vector<component_location> &locations);
+  void preload_components();
+  std::vector<symbol_table::symbol_id> prefetch_components(const symbol_set &names);
+  tf::Executor &get_executor();
   bool add_feature(c4::csubstr &feature_name);
   //std::optional<std::filesystem::path> find_component(const std::string component_dotname);
   void evaluate_choices();
@@ -77,7 +100,12 @@ public:
   void create_project_file();
   void process_construction(indicators::ProgressBar &bar);
   void save_summary();
+  bool restore_evaluation(const std::string &inputs);
+  void save_evaluation_fingerprint(const std::string &inputs);
+  std::vector<std::filesystem::path> evaluation_input_files() const;
   void save_blueprints();
+  void log_arena_usage() const;
+  void hash_summaries(tf::Executor &executor);
 
   void validate_schema();
   void update_project_data();
@@ -94,20 +122,23 @@ public:
   yakka::project::state current_state;
 
   // Component processing
-  std::unordered_set<c4::csubstr> unprocessed_components;
-  std::unordered_set<c4::csubstr> unprocessed_features;
+  // Sets of component and feature IDs are bitsets over the project's own interned IDs, so projects
+  // sharing a workspace can be evaluated concurrently
+  symbol_table symbols;
+  symbol_set unprocessed_components;
+  symbol_set unprocessed_features;
   std::unordered_set<c4::csubstr> unprocessed_choices;
   std::unordered_map<c4::csubstr, c4::csubstr> unprocessed_replacements;
   //std::unordered_set<c4::csubstr> replaced_components;
   std::unordered_map<c4::csubstr, c4::csubstr> replacements;
-  std::unordered_set<c4::csubstr> required_components;
-  std::unordered_set<c4::csubstr> required_features;
-  std::unordered_set<c4::csubstr> provided_features;
-  std::unordered_set<c4::csubstr> unprovided_features;
+  symbol_set required_components;
+  symbol_set required_features;
+  symbol_set provided_features;
+  symbol_set unprovided_features;
   std::map<c4::csubstr, ryml::ConstNodeRef> feature_recommendations;
   std::unordered_set<c4::csubstr> additional_tools;
   std::unordered_set<c4::csubstr> commands;
-  std::unordered_set<c4::csubstr> unknown_components;
+  symbol_set unknown_components;
   std::vector<std::pair<c4::csubstr, c4::csubstr>> incomplete_choices;
   std::vector<c4::csubstr> multiple_answer_choices;
   component_database::flag component_flags;
@@ -119,6 +150,11 @@ public:
   std::filesystem::path project_file;
   fs::file_time_type project_summary_last_modified;
   std::vector<std::shared_ptr<yakka::component>> components;
+  // Components parsed ahead of their wave or before resolution restarted, reused instead of parsing them again
+  std::unordered_map<symbol_table::symbol_id, std::shared_ptr<yakka::component>> retained_components;
+  // Reverse indexes from a supported component or feature ID to the positions in `components` that support it
+  std::unordered_map<c4::csubstr, std::set<size_t>> component_supporters;
+  std::unordered_map<c4::csubstr, std::set<size_t>> feature_supporters;
   //yakka::component_database component_database;
   yakka::blueprint_database blueprint_database;
   yakka::target_database target_database;
@@ -126,12 +162,19 @@ public:
   ryml::Tree project_data;
   ryml::NodeRef previous_summary;
   ryml::NodeRef project_summary;
+  yakka::mapped_file summary_snapshot; // Holds the scalars of a summary loaded from its snapshot
+  ryml::NodeRef cached_summary;        // Summary saved by the previous run, if any
+  yakka::node_hashes summary_hashes; // Merkle hashes of both summaries, indexed by node ID
 
   yakka::schema project_schema;
   yakka::schema data_schema;
 
   yakka::workspace &workspace;
 
+  // Executor for parallel work, shared between projects when set before evaluation. A local one is created otherwise.
+  tf::Executor *executor = nullptr;
+  std::unique_ptr<tf::Executor> owned_executor;
+
   // Blueprint evaluation
   inja::Environment inja_environment;
   //std::multimap<std::string, std::shared_ptr<blueprint_match> > target_database;
@@ -155,13 +198,17 @@ public:
   // SLC specific
   // ryml::Tree template_contributions;
   ryml::NodeRef template_contributions;
-  std::unordered_set<c4::csubstr> slc_required;
-  std::unordered_set<c4::csubstr> slc_provided;
+  ryml::NodeRef contribution_sources; // Contributions as gathered, process_slc_rules() adds the sorted form as a child
+  std::set<std::string> referenced_contributions; // Contribution names read by template files, each saved as a shard
+  std::set<std::filesystem::path> evaluation_reads; // Files other than components read while evaluating, see evaluation_input_files()
+  symbol_set slc_required;
+  symbol_set slc_provided;
   std::map<c4::csubstr, ryml::ConstNodeRef> slc_recommended;
   std::multimap<c4::csubstr, c4::csubstr> instances;
   std::multimap<c4::csubstr, const std::shared_ptr<yakka::component>> slc_overrides;
   bool is_disqualified_by_unless(ryml::ConstNodeRef node);
   bool condition_is_fulfilled(ryml::ConstNodeRef node);
+  bool is_active(ryml::ConstNodeRef node);
   void process_slc_rules();
   void create_config_file(const std::shared_ptr<yakka::component> component, ryml::ConstNodeRef config, const std::string &prefix, std::string instance_name);
 };
@@ -14,9 +14,266 @@
 #include <valijson/schema_parser.hpp>
 #include <valijson/validation_results.hpp>
 #include <valijson/validator.hpp>
+#include <algorithm>
+#include <vector>
 
 namespace yakka {
 
+namespace {
+
+/// @brief Executes parse_merge_strategy.
+
+schema::merge_strategy parse_merge_strategy(ryml::ConstNodeRef schema_node)
+{
+  if (!schema_node.valid() || !schema_node.is_map() || !schema_node.has_child("merge"))
+
+    return schema::merge_strategy::Default;
+
+  const auto merge = schema_node["merge"];
+  if (!merge.has_val())
+    return schema::merge_strategy::Default;
+
+  const auto name = merge.val();
+  if (name == "max")
+    return schema::merge_strategy::Max;
+  if (name == "min")
+    return schema::merge_strategy::Min;
+  if (name == "append")
+    return schema::merge_strategy::Append;
+  if (name == "abort")
+    return schema::merge_strategy::Abort;
+  if (name == "sort")
+    return schema::merge_strategy::Sort;
+  if (name == "unique")
+    return schema::merge_strategy::Unique;
+  if (name == "overwrite")
+    return schema::merge_strategy::Overwrite;
+  if (name != "concatenate" && name != "default")
+    spdlog::warn("Unknown merge strategy '{}'", name);
+  return schema::merge_strategy::Default;
+}
+
+/// @brief Executes property_schema.
+
+// Schema node describing the member `key` of an object described by `schema_node`
+ryml::ConstNodeRef property_schema(ryml::ConstNodeRef schema_node, ryml::csubstr key)
+{
+  if (!schema_node.valid() || !schema_node.is_map())
+
+    return ryml::ConstNodeRef{};
+
+  if (schema_node.has_child("properties")) {
+    const auto properties = schema_node["properties"];
+    if (properties.is_map() && properties.has_child(key))
+      return properties[key];
+  }
+  if (schema_node.has_child("additionalProperties") && schema_node["additionalProperties"].is_map())
+    return schema_node["additionalProperties"];
+  return ryml::ConstNodeRef{};
+}
+
+/// @brief Executes item_schema.
+
+// Schema node describing the items of an array described by `schema_node`
+ryml::ConstNodeRef item_schema(ryml::ConstNodeRef schema_node)
+{
+  if (!schema_node.valid() || !schema_node.is_map() || !schema_node.has_child("items"))
+
+    return ryml::ConstNodeRef{};
+
+  const auto items = schema_node["items"];
+  return items.is_map() ? items : ryml::ConstNodeRef{};
+}
+
+/// @brief Executes compare_scalars.
+
+// Numeric comparison when both scalars are numbers, lexical otherwise
+int compare_scalars(ryml::csubstr a, ryml::csubstr b)
+{
+  double a_number = 0;
+
+  double b_number = 0;
+  if (c4::atod(a, &a_number) && c4::atod(b, &b_number))
+    return (a_number > b_number) - (a_number < b_number);
+  return a.compare(b);
+}
+
+/// @brief Executes has_value.
+
+// Nodes created ahead of a merge carry the VAL flag without a scalar
+bool has_value(ryml::ConstNodeRef node)
+{
+  return node.has_val() && node.val().str != nullptr;
+}
+
+/// @brief Executes copy_scalar.
+
+// Scalars owned by another tree's arena are copied, everything else stays a view
+ryml::csubstr copy_scalar(ryml::NodeRef dst, ryml::ConstNodeRef src, ryml::csubstr scalar)
+{
+  if (src.tree() != dst.tree() && src.tree()->in_arena(scalar))
+
+    return dst.tree()->copy_to_arena(scalar);
+
+  return scalar;
+}
+
+/// @brief Executes sort_children.
+
+void sort_children(ryml::NodeRef node)
+{
+  auto *tree = node.tree();
+
+  std::vector<size_t> ids;
+  for (const auto &child: node.children())
+    ids.push_back(child.id());
+
+  // Scalars are ordered by value ahead of any nested structures, which keep their relative order
+  std::ranges::stable_sort(ids, [tree](size_t a, size_t b) {
+    const bool a_scalar = tree->has_val(a);
+    const bool b_scalar = tree->has_val(b);
+    if (a_scalar != b_scalar)
+      return a_scalar;
+    return a_scalar && compare_scalars(tree->val(a), tree->val(b)) < 0;
+  });
+
+  size_t after = ryml::NONE;
+  for (const auto id: ids) {
+    tree->move(id, after);
+    after = id;
+  }
+}
+
+/// @brief Executes remove_duplicate_children.
+
+void remove_duplicate_children(ryml::NodeRef node)
+{
+  auto *tree = node.tree();
+
+  std::vector<ryml::csubstr> seen;
+  for (size_t id = tree->first_child(node.id()); id != ryml::NONE;) {
+    const size_t next = tree->next_sibling(id);
+    if (tree->has_val(id)) {
+      const auto value = tree->val(id);
+      if (std::ranges::any_of(seen, [value](ryml::csubstr s) { return compare_scalars(s, value) == 0; }))
+        tree->remove(id);
+      else
+        seen.push_back(value);
+    }
+    id = next;
+  }
+}
+
+/// @brief Executes merge_with_strategy.
+
+// Walks `src` and the schema together so each level's strategy is found without rebuilding paths
+bool merge_with_strategy(ryml::NodeRef dst, ryml::ConstNodeRef src, ryml::ConstNodeRef schema_node)
+{
+  const auto strategy = parse_merge_strategy(schema_node);
+
+  bool result = true;
+
+  if (strategy == schema::merge_strategy::Overwrite) {
+    dst.tree()->remove_children(dst.id());
+    if (src.is_map())
+      dst.tree()->change_type(dst.id(), ryml::MAP);
+    else if (src.is_seq())
+      dst.tree()->change_type(dst.id(), ryml::SEQ);
+    else
+      dst.tree()->change_type(dst.id(), ryml::VAL);
+  }
+
+  if (src.is_map()) {
+    if (!dst.has_val() && !dst.is_seq())
+      dst |= ryml::MAP;
+    if (!dst.is_map()) {
+      spdlog::error("Merging map into non-map node. Source: '{}', Destination: '{}'", src.key(), dst.key());
+      return result;
+    }
+
+    for (const auto &ch: src.children()) {
+      const auto key = ch.key();
+      auto dst_child = dst.find_child(key);
+      if (!dst_child.valid()) {
+        dst_child = dst.append_child();
+        dst_child.set_key(copy_scalar(dst, src, key));
+      }
+      result &= merge_with_strategy(dst_child, ch, property_schema(schema_node, key));
+    }
+    return result;
+  }
+
+  if (src.is_seq()) {
+    // Appending to a single value turns it into the first entry of a sequence
+    if (strategy == schema::merge_strategy::Append && has_value(dst)) {
+      const auto existing = dst.val();
+      dst.tree()->change_type(dst.id(), ryml::SEQ);
+      dst.append_child().set_val(existing);
+    }
+    if (!dst.has_val() && !dst.is_map())
+      dst |= ryml::SEQ;
+    if (!dst.is_seq()) {
+      spdlog::error("Merging sequence into non-sequence node. Source: '{}', Destination: '{}'", src.key(), dst.key());
+      return result;
+    }
+
+    const auto items = item_schema(schema_node);
+    for (const auto &ch: src.children())
+      result &= merge_with_strategy(dst.append_child(), ch, items);
+  } else if (src.has_val()) {
+    const auto value = copy_scalar(dst, src, src.val());
+
+    if (dst.is_seq()) {
+      dst.append_child().set_val(value);
+    } else if (dst.is_map()) {
+      spdlog::error("Merging scalar into map. Source: '{}', Destination: '{}'", src.key(), dst.key());
+      return result;
+    } else if (!has_value(dst)) {
+      dst.set_val(value);
+    } else {
+      switch (strategy) {
+        case schema::merge_strategy::Max:
+          if (compare_scalars(value, dst.val()) > 0)
+            dst.set_val(value);
+          break;
+        case schema::merge_strategy::Min:
+          if (compare_scalars(value, dst.val()) < 0)
+            dst.set_val(value);
+          break;
+        case schema::merge_strategy::Append: {
+          const auto existing = dst.val();
+          dst.tree()->change_type(dst.id(), ryml::SEQ);
+          dst.append_child().set_val(existing);
+          dst.append_child().set_val(value);
+          break;
+        }
+        case schema::merge_strategy::Abort:
+          if (dst.val() != value) {
+            spdlog::error("Conflicting values '{}' and '{}' for '{}'", dst.val(), value, src.key());
+            return false;
+          }
+          break;
+        default:
+          dst.set_val(value);
+          break;
+      }
+    }
+  } else {
+    spdlog::error("Merging node with unknown type. Source: '{}', Destination: '{}'", src.key(), dst.key());
+    return result;
+  }
+
+  if (dst.is_seq()) {
+    if (strategy == schema::merge_strategy::Sort)
+      sort_children(dst);
+    else if (strategy == schema::merge_strategy::Unique)
+      remove_duplicate_children(dst);
+  }
+  return result;
+}
+
+} // namespace
+
 /// @brief Executes schema.
 
 schema::schema(const std::string &schema_yaml) : schema_data()
@@ -56,6 +313,9 @@ void schema::add_schema_data(ryml::ConstNodeRef schema_data)
     return;
   }
 
+  // get_compiled_schema() reads the schema data under the same lock
+  std::lock_guard lock(compile_mutex);
+
   auto root = this->schema_data.rootref();
   if (!root.has_children()) {
     root |= ryml::MAP;
@@ -63,8 +323,31 @@ void schema::add_schema_data(ryml::ConstNodeRef schema_data)
     auto properties = root.append_child() << ryml::key("properties");
     properties |= ryml::MAP;
   }
-  merge_nodes(root["properties"], schema_data);
-  validator_updated = false;
+  ryml_merge(root["properties"], schema_data);
+
+  compiled_schema.reset();
+  compile_failed = false;
+}
+
+/// @brief Executes get_compiled_schema.
+
+std::shared_ptr<const valijson::Schema> schema::get_compiled_schema()
+{
+  std::lock_guard lock(compile_mutex);
+
+  if (compiled_schema || compile_failed)
+    return compiled_schema;
+
+  try {
+    auto parsed_schema = std::make_shared<valijson::Schema>();
+    valijson::SchemaParser parser;
+    parser.populateSchema(valijson::adapters::RymlAdapter(schema_data.crootref()), *parsed_schema);
+    compiled_schema = std::move(parsed_schema);
+  } catch (const std::exception &e) {
+    compile_failed = true;
+    spdlog::error("Failed to compile schema: {}", e.what());
+  }
+  return compiled_schema;
 }
 
 /// @brief Executes validate.
@@ -82,15 +365,16 @@ bool schema::validate(ryml::ConstNodeRef data, ryml::csubstr id)
     return true;
   }
 
-  try {
-    valijson::Schema parsed_schema;
-    valijson::SchemaParser parser;
-    parser.populateSchema(valijson::adapters::RymlAdapter(schema_root), parsed_schema);
-    validator_updated = true;
+  const auto compiled = get_compiled_schema();
+  if (!compiled) {
+    spdlog::error("Schema validation failed for '{}': schema could not be compiled", ryml_string(id));
+    return false;
+  }
 
+  try {
     valijson::Validator validator(valijson::Validator::kWeakTypes);
     valijson::ValidationResults results;
-    const bool is_valid = validator.validate(parsed_schema, valijson::adapters::RymlAdapter(data), &results);
+    const bool is_valid = validator.validate(*compiled, valijson::adapters::RymlAdapter(data), &results);
     if (is_valid) {
       return true;
     }
@@ -106,7 +390,6 @@ bool schema::validate(ryml::ConstNodeRef data, ryml::csubstr id)
 
     return false;
   } catch (const std::exception &e) {
-    validator_updated = false;
     spdlog::error("Schema validation failed for '{}': {}", ryml_string(id), e.what());
     return false;
   }
@@ -136,9 +419,22 @@ bool schema::validate(ryml::ConstNodeRef data, ryml::csubstr id)
 
 ryml::ConstNodeRef schema::operator[](const ryml::Pointer &path) const
 {
-  // TODO
-  return ryml::ConstNodeRef{};
-  // return (*this)[path.to_string()];
+  auto current = schema_data.crootref();
+
+  if (!current.valid())
+    return ryml::ConstNodeRef{};
+
+  // Only the schema keywords describe members, so data named like a keyword (e.g. `type`) is not mistaken for one
+  for (const auto &segment: path.tokens()) {
+    auto next = property_schema(current, segment);
+    if (!next.valid() && segment.is_integer())
+      next = item_schema(current);
+    if (!next.valid())
+      return ryml::ConstNodeRef{};
+    current = next;
+  }
+
+  return current;
 }
 
 ryml::ConstNodeRef schema::operator[](const std::string &path) const
@@ -194,33 +490,14 @@ ryml::ConstNodeRef schema::operator[](const std::string &path) const
 
 schema::merge_strategy schema::get_merge_strategy(const ryml::Pointer &path) const
 {
-  // ryml::Tree temp_schema = this->schema_data;
-
-  // std::string path_str = path.to_string();
-  // for (const auto &part_range: std::views::split(path_str, '/')) {
-  //   std::string part(part_range.begin(), part_range.end());
-  //   if (part.empty())
-  //     continue;
-  //   if (temp_schema["properties"].contains(part)) {
-  //     temp_schema = temp_schema["properties"][part];
-  //   } else {
-  //     return schema::merge_strategy::Default;
-  //   }
-  // }
-  // if (temp_schema["merge"].is_string()) {
-  //   std::string merge_str = temp_schema["merge"].get<std::string>();
-  //   if (merge_str == "concatenate")
-  //     return schema::merge_strategy::Default;
-  //   else if (merge_str == "max")
-  //     return schema::merge_strategy::Max;
-  //   else if (merge_str == "min")
-  //     return schema::merge_strategy::Min;
-  //   else if (merge_str == "sort")
-  //     return schema::merge_strategy::Sort;
-  //   else if (merge_str == "unique")
-  //     return schema::merge_strategy::Unique;
-  // }
-  return schema::merge_strategy::Default;
+  return parse_merge_strategy((*this)[path]);
+}
+
+/// @brief Executes merge.
+
+bool schema::merge(ryml::NodeRef dst, ryml::ConstNodeRef src, const ryml::Pointer &path) const
+{
+  return merge_with_strategy(dst, src, (*this)[path]);
 }
 
 yakka_schema_validator::yakka_schema_validator() : 
@@ -230,6 +507,14 @@ yakka_schema_validator::yakka_schema_validator() :
 {
 }
 
+/// @brief Executes schema_digest.
+
+const std::string &yakka_schema_validator::schema_digest()
+{
+  static const std::string digest = content_digest(yakka_component_schema_yaml + slcc_schema_yaml);
+  return digest;
+}
+
 /// @brief Executes validate.
 
 bool yakka_schema_validator::validate(yakka::component *component)
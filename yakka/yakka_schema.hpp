@@ -7,8 +7,14 @@
 // #include <ryml/json-schema.hpp>
 #include "spdlog.h"
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <ranges>
 
+namespace valijson {
+class Schema;
+}
+
 namespace yakka {
 
 // clang-format off
@@ -71,6 +77,8 @@ properties:
             type: string
           group:
             type: string
+          depfile:
+            type: string
           depends:
             type: array
           process:
@@ -163,15 +171,22 @@ public:
 
   void add_schema_data(ryml::ConstNodeRef schema_data);
   // bool validate(ryml::ConstNodeRef data, std::string id = "");
+  // Thread safe, the compiled schema is shared read-only between concurrent validations
   bool validate(ryml::ConstNodeRef data, ryml::csubstr id);
   ryml::ConstNodeRef operator[](const ryml::Pointer &path) const;
   ryml::ConstNodeRef operator[](const std::string &path) const;
   schema::merge_strategy get_merge_strategy(const ryml::Pointer &path) const;
+  // Merges `src` into `dst` using the `merge` strategies declared at and below `path`, returns false if an `abort` conflict was hit
+  bool merge(ryml::NodeRef dst, ryml::ConstNodeRef src, const ryml::Pointer &path) const;
 
 private:
+  std::shared_ptr<const valijson::Schema> get_compiled_schema();
+
   ryml::Tree schema_data;
   // ryml_schema::json_validator validator;
-  bool validator_updated = false;
+  std::mutex compile_mutex;
+  std::shared_ptr<const valijson::Schema> compiled_schema; // Built from schema_data on first use, reset by add_schema_data()
+  bool compile_failed = false;
 };
 
 class yakka_schema_validator {
@@ -205,6 +220,9 @@ public:
   void operator=(yakka_schema_validator const &)   = delete;
 
   bool validate(yakka::component *component);
+
+  // Digest of the built-in component schemas, so results of validation can be cached
+  static const std::string &schema_digest();
 };
 
 // schema_validator yakka_validator();
@@ -6,6 +6,7 @@
 #include "yakka.hpp"
 #include "yakka_workspace.hpp"
 #include "component_database.hpp"
+#include "yakka_component.hpp"
 #include "utilities.hpp"
 
 #include "spdlog/sinks/basic_file_sink.h"
@@ -16,6 +17,8 @@
 #include <string_view>
 #include <ranges>
 #include <format>
+#include <algorithm>
+#include <iterator>
 
 namespace fs = std::filesystem;
 
@@ -82,6 +85,14 @@ ryml::NodeRef ensure_child_scalar(ryml::NodeRef parent, c4::csubstr key, c4::csu
   return child;
 }
 
+/// @brief Executes ~workspace.
+
+// Snapshots written while the workspace was in use are added to the saved count
+workspace::~workspace()
+{
+  component::save_cache_count();
+}
+
 // Using std::expected for error handling
 /// @brief Executes init.
 
@@ -110,6 +121,16 @@ std::expected<void, std::error_code> workspace::init(const std::filesystem::path
     return std::unexpected(e.code());
   }
 
+  // Parsed components are cached in the shared home so every workspace can reuse them
+  std::error_code cache_error;
+  component::cache_directory = yakka_shared_home / component_cache_directory / component::cache_subdirectory();
+  fs::create_directories(component::cache_directory, cache_error);
+  if (cache_error) {
+    spdlog::warn("Component cache disabled: {}", cache_error.message());
+    component::cache_directory.clear();
+  }
+  component::remove_stale_caches();
+
   // Using ranges for directory creation
   const std::array dirs = { workspace_path / ".yakka/registries", workspace_path / ".yakka/repos" };
 
@@ -119,6 +140,9 @@ std::expected<void, std::error_code> workspace::init(const std::filesystem::path
     }
   }
 
+  for (auto *db: { &local_database, &shared_database })
+    db->scan_ignore.insert(db->scan_ignore.end(), scan_ignore.begin(), scan_ignore.end());
+
   auto result = local_database.load(this->workspace_path);
   if (!result) {
     spdlog::error("Failed to load local database: {}\n", result.error().message());
@@ -139,7 +163,9 @@ std::expected<void, std::error_code> workspace::init(const std::filesystem::path
 /// @brief Executes for_each.
 
     std::ranges::for_each(packages, [this](const auto &p) {
-      auto result = package_databases.emplace_back().load(p);
+      auto &db = package_databases.emplace_back();
+      db.scan_ignore.insert(db.scan_ignore.end(), scan_ignore.begin(), scan_ignore.end());
+      auto result = db.load(p);
       if (!result) {
 
         spdlog::error("Failed to load package database at {}: {}\n", p.string(), result.error().message());
@@ -295,6 +321,35 @@ std::optional<std::pair<std::filesystem::path, std::filesystem::path>> workspace
   return std::nullopt;
 }
 
+/// @brief Executes find_component_files.
+
+std::vector<std::filesystem::path> workspace::find_component_files(const std::filesystem::path &directory, std::string_view extension) const
+{
+  auto files = local_database.get_component_files(directory, extension);
+  std::ranges::copy(shared_database.get_component_files(directory, extension), std::back_inserter(files));
+  for (const auto &db: package_databases)
+    std::ranges::copy(db.get_component_files(directory, extension), std::back_inserter(files));
+
+  std::ranges::sort(files);
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
+
+/// @brief Executes find_component_metadata.
+
+std::optional<ryml::ConstNodeRef> workspace::find_component_metadata(const std::filesystem::path &component_file) const
+{
+  if (auto metadata = local_database.get_component_metadata(component_file))
+
+    return metadata;
+  if (auto metadata = shared_database.get_component_metadata(component_file))
+    return metadata;
+  for (const auto &db: package_databases)
+    if (auto metadata = db.get_component_metadata(component_file))
+      return metadata;
+  return std::nullopt;
+}
+
 /// @brief Executes find_feature.
 
 std::optional<ryml::ConstNodeRef> workspace::find_feature(ryml::csubstr feature) const
@@ -411,6 +466,14 @@ std::expected<void, std::error_code> workspace::load_config_file(const std::file
       }
     }
 
+    if (configuration.has_child("scan_ignore")) {
+      auto ignore_summary = ensure_child_seq(config_node, "scan_ignore");
+      for (const auto &i: configuration["scan_ignore"].children()) {
+        scan_ignore.push_back(i.val<std::string>().value());
+        ignore_summary.append_child() << scan_ignore.back();
+      }
+    }
+
     if (configuration.has_child("home")) {
       yakka_shared_home                 = std::filesystem::path(configuration["home"].val<std::string>().value());
       ensure_child_scalar(config_node, "home", c4::to_csubstr(yakka_shared_home.string()));
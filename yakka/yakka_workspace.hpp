@@ -24,8 +24,8 @@ class workspace {
 public:
   /** @brief Default constructor */
   workspace() = default;
-  /** @brief Default destructor */
-  ~workspace() = default;
+  /** @brief Saves the component cache count */
+  ~workspace();
 
   /**
    * @brief Initializes the workspace with given path
@@ -85,6 +85,21 @@ public:
    */
   std::optional<std::pair<std::filesystem::path, std::filesystem::path>> find_component(ryml::csubstr component_dotname, component_database::flag flags = component_database::flag::ALL_COMPONENTS);
 
+  /**
+   * @brief Lists the indexed component files under a directory
+   * @param directory Directory to search below
+   * @param extension Component file extension, e.g. ".slcc"
+   * @return Sorted, de-duplicated paths from the local, shared and package databases
+   */
+  std::vector<std::filesystem::path> find_component_files(const std::filesystem::path &directory, std::string_view extension) const;
+
+  /**
+   * @brief Finds the resolution metadata indexed for a component file
+   * @param component_file Path of the component file as returned by find_component()
+   * @return The metadata node from the first database that indexed the file
+   */
+  std::optional<ryml::ConstNodeRef> find_component_metadata(const std::filesystem::path &component_file) const;
+
   /**
    * @brief Finds a feature provider in the workspace
    * @param feature Name of the feature to find
@@ -208,6 +223,9 @@ public:
   /** @brief List of package paths to search */
   std::vector<std::filesystem::path> packages;
 
+  /** @brief Additional directories skipped when scanning for components, see component_database::scan_ignore */
+  std::vector<std::string> scan_ignore;
+
   /** @brief Collection of component databases from package paths */
   std::vector<component_database> package_databases;
 };